@@ -0,0 +1,146 @@
+﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
+#include "MGDNRuntimeNavMesh.h"
+#include "MGDNSearchState.h"
+
+// Bidirectional A* on the voxel grid.
+// One search runs from the start towards the end and one from the end towards the start,
+// each with its own records. Moves are symmetric, so the backward search uses the same move
+// masks. Every time one side reaches a cell the other side has a cost for, the joined path
+// becomes a candidate.
+// Both sides rank cells by the average potential (hF - hB) / 2, the backward side by its
+// negation, which keeps the heuristic consistent in both directions. With it the search can
+// stop as soon as the two lowest keys add up to the best candidate, long before a plain
+// f bound would, so the two frontiers meet near the middle instead of passing each other.
+
+bool UMGDNRuntimeNavMesh::BidirectionalSearch(int32 Start, int32 End, TArray<int32>& OutIndices, FMGDNSearchStats* OutStats,
+                                              float MinClearance) const
+{
+	OutIndices.Reset();
+
+	if (Start == End)
+	{
+		OutIndices.Add(Start);
+		return true;
+	}
+
+	if (NumCellIndices() <= 0)
+		return false;
+
+	FMGDNScopedSearchState ForwardSearch;
+	FMGDNScopedSearchState BackwardSearch;
+	FMGDNSearchState& Forward  = *ForwardSearch;
+	FMGDNSearchState& Backward = *BackwardSearch;
+
+	FIntVector StartXYZ, EndXYZ;
+	ToXYZ(Start, StartXYZ.X, StartXYZ.Y, StartXYZ.Z);
+	ToXYZ(End, EndXYZ.X, EndXYZ.Y, EndXYZ.Z);
+
+	const float* StartCosts = GetLandmarkCosts(Start);
+	const float* EndCosts   = GetLandmarkCosts(End);
+
+	// Forward potential of a cell, the backward side uses its negation
+	auto Potential = [this, &StartXYZ, &EndXYZ, StartCosts, EndCosts](int32 Index, int32 X, int32 Y, int32 Z)
+	{
+		return 0.5f * (PathHeuristic(Index, X, Y, Z, EndXYZ, EndCosts) - PathHeuristic(Index, X, Y, Z, StartXYZ, StartCosts));
+	};
+
+	FMGDNSearchStats Stats;
+
+	const float StartKey = Potential(Start, StartXYZ.X, StartXYZ.Y, StartXYZ.Z);
+	const float EndKey   = -Potential(End, EndXYZ.X, EndXYZ.Y, EndXYZ.Z);
+
+	Forward.Begin(NumCellIndices());
+	Forward.Visit(Start).G = 0.f;
+	Forward.Push(Start, StartKey, StartKey);
+
+	Backward.Begin(NumCellIndices());
+	Backward.Visit(End).G = 0.f;
+	Backward.Push(End, EndKey, EndKey);
+
+	Stats.Pushes += 2;
+
+	float BestCost = FLT_MAX;
+	int32 Meet = INDEX_NONE;
+
+	while (!Forward.IsOpenEmpty() && !Backward.IsOpenEmpty())
+	{
+		if (Forward.PeekF() + Backward.PeekF() >= BestCost)
+			break;
+
+		// Grow the smaller frontier, which keeps both sides about the same size
+		const bool bForward = Forward.Heap.Num() <= Backward.Heap.Num();
+
+		FMGDNSearchState& S     = bForward ? Forward : Backward;
+		FMGDNSearchState& Other = bForward ? Backward : Forward;
+		const float Sign = bForward ? 1.f : -1.f;
+
+		const int32 Current = S.Pop();
+		Stats.Expansions++;
+
+		const float CurrentG = S.Records[Current].G;
+
+		int32 CX, CY, CZ;
+		ToXYZ(Current, CX, CY, CZ);
+
+		uint32 Moves = GetMoveMask(Current);
+		while (Moves)
+		{
+			const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+			Moves &= Moves - 1;
+
+			const int32 NIndex = StepIndex(Current, CX, CY, CZ, Bit);
+
+			// Both ends are exempt, the backward side steps onto Start like the forward side onto End
+			if (NIndex != Start && NIndex != End && !HasClearance(NIndex, MinClearance))
+				continue;
+
+			FMGDNCellRecord& N = S.Visit(NIndex);
+
+			if (N.HeapSlot == FMGDNSearchState::ClosedSlot)
+				continue;
+
+			const float NewG = CurrentG + MoveCost(Bit);
+
+			if (NewG < N.G)
+			{
+				N.G      = NewG;
+				N.Parent = Current;
+
+				const FIntVector D = FMGDNWalkableBits::BitDelta(Bit);
+				const float P = Sign * Potential(NIndex, CX + D.X, CY + D.Y, CZ + D.Z);
+				S.Push(NIndex, NewG + P, P);
+				Stats.Pushes++;
+			}
+
+			if (Other.IsVisited(NIndex))
+			{
+				const float Joined = N.G + Other.Records[NIndex].G;
+				if (Joined < BestCost)
+				{
+					BestCost = Joined;
+					Meet = NIndex;
+				}
+			}
+		}
+	}
+
+	const bool bFound = Meet != INDEX_NONE;
+
+	if (bFound)
+	{
+		// Start to the meeting cell, then the backward parents lead on to End
+		Forward.BuildPath(Meet, OutIndices);
+
+		for (int32 Trace = Backward.Records[Meet].Parent; Trace != INDEX_NONE; Trace = Backward.Records[Trace].Parent)
+		{
+			OutIndices.Add(Trace);
+		}
+	}
+
+	if (OutStats)
+	{
+		*OutStats = Stats;
+	}
+
+	return bFound;
+}
@@ -0,0 +1,187 @@
+﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
+#include "MGDNRuntimeNavMesh.h"
+#include "MGDNSearchState.h"
+
+// Flow fields for many agents heading to the same cell.
+// One Dijkstra search grows out of the goal over its whole region. Moves are symmetric, so
+// the move a cell was reached through, reversed, is that cell's first step on a shortest path
+// to the goal. Following those steps needs no search at all, however many agents do it.
+
+TSharedPtr<const FMGDNFlowField> UMGDNRuntimeNavMesh::GetFlowField(int32 GoalIndex, float AgentRadius) const
+{
+	if (!Walkable.IsValidIndex(GoalIndex) || !IsOpen(GoalIndex))
+		return nullptr;
+
+	const float MinClearance = RequiredClearance(AgentRadius);
+
+	// Exact clearance bits, a field built for a slightly narrower agent would route this one through cells too tight for it
+	uint32 ClearanceBits;
+	FMemory::Memcpy(&ClearanceBits, &MinClearance, sizeof(ClearanceBits));
+	const uint64 Key = uint64(uint32(GoalIndex)) | (uint64(ClearanceBits) << 32);
+
+	// Held while building, so a burst of requests for one goal runs the search once
+	FScopeLock Lock(&FlowFieldLock);
+
+	if (const TWeakPtr<const FMGDNFlowField>* Cached = FlowFields.Find(Key))
+	{
+		if (TSharedPtr<const FMGDNFlowField> Field = Cached->Pin())
+			return Field;
+	}
+
+	TSharedPtr<FMGDNFlowField> Field = MakeShared<FMGDNFlowField>();
+	Field->Goal = GoalIndex;
+	Field->MinClearance = MinClearance;
+	Field->NavVersion = NavVersion;
+	BuildFlowField(*Field);
+
+	// Drop entries whose last holder is gone
+	for (auto It = FlowFields.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().Pin())
+			It.RemoveCurrent();
+	}
+
+	FlowFields.Add(Key, Field);
+	return Field;
+}
+
+void UMGDNRuntimeNavMesh::BuildFlowField(FMGDNFlowField& Field) const
+{
+	Field.Moves.Init(FMGDNFlowField::NoMove, Connectivity.Num());
+
+	FMGDNScopedSearchState Search;
+	FMGDNSearchState& S = *Search;
+
+	S.Begin(NumCellIndices());
+	S.Visit(Field.Goal).G = 0.f;
+	S.Push(Field.Goal, 0.f);
+
+	int32 Expansions = 0;
+
+	while (!S.IsOpenEmpty())
+	{
+		const int32 Current = S.Pop();
+		Expansions++;
+
+		const float CurrentG = S.Records[Current].G;
+
+		int32 CX, CY, CZ;
+		ToXYZ(Current, CX, CY, CZ);
+
+		uint32 Moves = GetMoveMask(Current);
+		while (Moves)
+		{
+			const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+			Moves &= Moves - 1;
+
+			const int32 NIndex = StepIndex(Current, CX, CY, CZ, Bit);
+			FMGDNCellRecord& N = S.Visit(NIndex);
+
+			if (N.HeapSlot == FMGDNSearchState::ClosedSlot)
+				continue;
+
+			const float NewG = CurrentG + MoveCost(Bit);
+
+			if (NewG < N.G)
+			{
+				N.G = NewG;
+
+				// The opposite offset, back towards Current
+				Field.Moves[Walkable.Rank(NIndex)] = uint8(26 - Bit);
+
+				// Narrow cells still get a way out, like a path start, but no path runs through them
+				if (HasClearance(NIndex, Field.MinClearance))
+				{
+					S.Push(NIndex, NewG);
+				}
+			}
+		}
+	}
+
+	UE_LOG(LogTemp, Verbose,
+		TEXT("[MGDN] BuildFlowField: Goal=%d Clearance=%.1f Expansions=%d"), Field.Goal, Field.MinClearance, Expansions);
+}
+
+bool UMGDNRuntimeNavMesh::FollowFlowField(const FMGDNFlowField& Field, int32 StartIndex, TArray<int32>& OutIndices) const
+{
+	OutIndices.Reset();
+
+	// Fields built before the last BuildFromAsset no longer match the grid
+	if (Field.Moves.Num() != Connectivity.Num() || !Walkable.IsValidIndex(Field.Goal) || !Walkable[Field.Goal])
+		return false;
+
+	if (!Walkable.IsValidIndex(StartIndex) || !Walkable[StartIndex])
+		return false;
+
+	int32 Index = StartIndex;
+	OutIndices.Add(Index);
+
+	while (Index != Field.Goal)
+	{
+		const uint8 Bit = Field.Moves[Walkable.Rank(Index)];
+
+		// No way to the goal, or a stale field walking in circles or through blocked moves
+		if (Bit == FMGDNFlowField::NoMove || OutIndices.Num() > Field.Moves.Num() || !((GetMoveMask(Index) >> Bit) & 1))
+		{
+			OutIndices.Reset();
+			return false;
+		}
+
+		int32 X, Y, Z;
+		ToXYZ(Index, X, Y, Z);
+
+		Index = StepIndex(Index, X, Y, Z, Bit);
+		OutIndices.Add(Index);
+	}
+
+	return true;
+}
+
+bool UMGDNRuntimeNavMesh::FindFlowPath(
+	const FTransform& PlatformTransform,
+	const FVector& StartWorld,
+	const FVector& EndWorld,
+	TArray<FVector>& OutWorldPath,
+	TSharedPtr<const FMGDNFlowField>& InOutField,
+	const FMGDNPathQuery& Query
+) const
+{
+	OutWorldPath.Reset();
+
+	// Fields only hold every move at its length, other moves and cell costs get a path of their own
+	if (!HasDefaultMoves(Query))
+	{
+		InOutField.Reset();
+		return FindPath(PlatformTransform, StartWorld, EndWorld, OutWorldPath, Query);
+	}
+
+	int32 StartIndex, EndIndex;
+	if (!ResolvePathCells(PlatformTransform, StartWorld, EndWorld, StartIndex, EndIndex))
+		return false;
+
+	const bool bReuse = InOutField &&
+		InOutField->Goal == EndIndex &&
+		InOutField->MinClearance == RequiredClearance(Query.AgentRadius) &&
+		InOutField->NavVersion == NavVersion;
+
+	if (!bReuse)
+	{
+		InOutField = GetFlowField(EndIndex, Query.AgentRadius);
+	}
+
+	TArray<int32> IndexPath;
+	if (!InOutField || !FollowFlowField(*InOutField, StartIndex, IndexPath))
+	{
+		// Verbose, one unreachable goal handed to a whole crowd would log once per agent
+		UE_LOG(LogTemp, Verbose, TEXT("[MGDN] FindFlowPath: No flow from %d to %d"), StartIndex, EndIndex);
+		return false;
+	}
+
+	if (Query.bSmoothPath)
+	{
+		SmoothIndexPath(IndexPath, Query);
+	}
+
+	IndexPathToWorld(PlatformTransform, IndexPath, OutWorldPath);
+	return OutWorldPath.Num() > 0;
+}
@@ -0,0 +1,576 @@
+﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
+#include "MGDNRuntimeNavMesh.h"
+#include "MGDNSearchState.h"
+
+// Hierarchical path search (HPA*) on the voxel grid.
+// BuildClusterGraph cuts the grid into clusters and links their entrances once at load.
+// A query connects start and goal to the entrances of their own clusters, searches the
+// small abstract graph and then runs bounded A* only inside the clusters on that route,
+// so a long query costs roughly the number of clusters crossed instead of the grid volume.
+
+namespace
+{
+	// Widest run of border crossings that shares one entrance node pair
+	constexpr int32 MaxEntranceWidth = 8;
+
+	struct FMGDNTransition
+	{
+		int32 From = INDEX_NONE;
+		int32 To = INDEX_NONE;
+		FIntVector FromXYZ;
+		FIntVector ToXYZ;
+	};
+
+	int32 FindRoot(TArray<int32>& Parents, int32 I)
+	{
+		while (Parents[I] != I)
+		{
+			Parents[I] = Parents[Parents[I]];
+			I = Parents[I];
+		}
+		return I;
+	}
+
+	void AddEdgeOnce(TArray<FMGDNClusterEdge>& Edges, int32 To, float Cost)
+	{
+		for (FMGDNClusterEdge& E : Edges)
+		{
+			if (E.To == To)
+			{
+				E.Cost = FMath::Min(E.Cost, Cost);
+				return;
+			}
+		}
+
+		FMGDNClusterEdge Edge;
+		Edge.To = To;
+		Edge.Cost = Cost;
+		Edges.Add(Edge);
+	}
+}
+
+void UMGDNRuntimeNavMesh::BuildClusterGraph()
+{
+	FMGDNClusterGraph& G = ClusterGraph;
+	G.Reset();
+
+	const int32 CS = FMath::Max(ClusterSize, 2);
+
+	G.ClusterSize = CS;
+	G.GridSize = FIntVector(GridX, GridY, GridZ);
+	G.NumClusters = FIntVector(
+		FMath::DivideAndRoundUp(GridX, CS),
+		FMath::DivideAndRoundUp(GridY, CS),
+		FMath::DivideAndRoundUp(GridZ, CS));
+
+	const int32 NumClusters = G.NumClusters.X * G.NumClusters.Y * G.NumClusters.Z;
+	G.ClusterNodes.SetNum(NumClusters);
+
+	// ---------------------------------------------------------------------
+	// 1. Collect every move that leaves a cluster, keyed by the cluster pair
+	// ---------------------------------------------------------------------
+	TMap<uint64, TArray<FMGDNTransition>> PairTransitions;
+
+	for (int32 Z = 0; Z < GridZ; Z++)
+	for (int32 Y = 0; Y < GridY; Y++)
+	for (int32 X = 0; X < GridX; X++)
+	{
+		const bool bOnBorder =
+			X % CS == 0 || X % CS == CS - 1 ||
+			Y % CS == 0 || Y % CS == CS - 1 ||
+			Z % CS == 0 || Z % CS == CS - 1;
+
+		if (!bOnBorder)
+			continue;
+
+		const int32 Index = ToIndex(X, Y, Z);
+		if (!Walkable[Index])
+			continue;
+
+		const int32 Cluster = G.ClusterOf(X, Y, Z);
+
+		uint32 Moves = GetMoveMask(Index);
+		while (Moves)
+		{
+			const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+			Moves &= Moves - 1;
+
+			const FIntVector D = FMGDNWalkableBits::BitDelta(Bit);
+			const int32 NX = X + D.X;
+			const int32 NY = Y + D.Y;
+			const int32 NZ = Z + D.Z;
+
+			// Moves are symmetric, record each pair from its lower cluster only
+			const int32 NCluster = G.ClusterOf(NX, NY, NZ);
+			if (NCluster <= Cluster)
+				continue;
+
+			FMGDNTransition T;
+			T.From    = Index;
+			T.To      = ToIndex(NX, NY, NZ);
+			T.FromXYZ = FIntVector(X, Y, Z);
+			T.ToXYZ   = FIntVector(NX, NY, NZ);
+
+			PairTransitions.FindOrAdd((uint64(Cluster) << 32) | uint64(NCluster)).Add(T);
+		}
+	}
+
+	TArray<uint64> Pairs;
+	for (const auto& It : PairTransitions)
+	{
+		Pairs.Add(It.Key);
+	}
+	Pairs.Sort();
+
+	// ---------------------------------------------------------------------
+	// 2. Group crossings into entrances and give each entrance a node pair
+	// ---------------------------------------------------------------------
+	TMap<int32, int32> CellToNode;
+
+	auto GetOrAddNode = [&G, &CellToNode](int32 Cell, int32 Cluster) -> int32
+	{
+		if (const int32* Existing = CellToNode.Find(Cell))
+			return *Existing;
+
+		const int32 Node = G.NodeCell.Add(Cell);
+		G.NodeCluster.Add(Cluster);
+		G.NodeEdges.AddDefaulted();
+		G.ClusterNodes[Cluster].Add(Node);
+
+		CellToNode.Add(Cell, Node);
+		return Node;
+	};
+
+	for (const uint64 Pair : Pairs)
+	{
+		const TArray<FMGDNTransition>& Transitions = PairTransitions[Pair];
+		const int32 FromCluster = int32(Pair >> 32);
+		const int32 ToCluster   = int32(Pair & 0xffffffff);
+
+		// Crossings belong to one entrance when both their sides are one move apart, so the
+		// cells of an entrance stay connected inside each of the two clusters
+		TMap<int32, TArray<int32>> ByFromCell;
+		for (int32 i = 0; i < Transitions.Num(); ++i)
+		{
+			ByFromCell.FindOrAdd(Transitions[i].From).Add(i);
+		}
+
+		// Same cell, or a move from A reaches B
+		auto IsLinked = [this](int32 AIndex, const FIntVector& A, const FIntVector& B)
+		{
+			const FIntVector D = B - A;
+
+			if (FMath::Abs(D.X) > 1 || FMath::Abs(D.Y) > 1 || FMath::Abs(D.Z) > 1)
+				return false;
+
+			return D == FIntVector::ZeroValue || CanMove(AIndex, D.X, D.Y, D.Z);
+		};
+
+		TArray<int32> Parents;
+		Parents.SetNum(Transitions.Num());
+		for (int32 i = 0; i < Parents.Num(); ++i)
+		{
+			Parents[i] = i;
+		}
+
+		for (int32 i = 0; i < Transitions.Num(); ++i)
+		{
+			const FMGDNTransition& T = Transitions[i];
+
+			for (int32 DZ = -1; DZ <= 1; DZ++)
+			for (int32 DY = -1; DY <= 1; DY++)
+			for (int32 DX = -1; DX <= 1; DX++)
+			{
+				const int32 NX = T.FromXYZ.X + DX;
+				const int32 NY = T.FromXYZ.Y + DY;
+				const int32 NZ = T.FromXYZ.Z + DZ;
+
+				if (!IsValid(NX, NY, NZ))
+					continue;
+
+				const TArray<int32>* Others = ByFromCell.Find(ToIndex(NX, NY, NZ));
+				if (!Others)
+					continue;
+
+				if (!IsLinked(T.From, T.FromXYZ, FIntVector(NX, NY, NZ)))
+					continue;
+
+				for (int32 j : *Others)
+				{
+					if (j != i && IsLinked(T.To, T.ToXYZ, Transitions[j].ToXYZ))
+					{
+						Parents[FindRoot(Parents, i)] = FindRoot(Parents, j);
+					}
+				}
+			}
+		}
+
+		TMap<int32, TArray<int32>> Entrances;
+		for (int32 i = 0; i < Transitions.Num(); ++i)
+		{
+			Entrances.FindOrAdd(FindRoot(Parents, i)).Add(i);
+		}
+
+		TArray<int32> Roots;
+		for (const auto& It : Entrances)
+		{
+			Roots.Add(It.Key);
+		}
+		Roots.Sort();
+
+		for (const int32 Root : Roots)
+		{
+			TArray<int32>& Members = Entrances[Root];
+			Members.Sort();
+
+			// Wide openings get one crossing per chunk, taken from the middle of the chunk
+			for (int32 First = 0; First < Members.Num(); First += MaxEntranceWidth)
+			{
+				const int32 Count = FMath::Min(MaxEntranceWidth, Members.Num() - First);
+				const FMGDNTransition& T = Transitions[Members[First + Count / 2]];
+
+				const int32 A = GetOrAddNode(T.From, FromCluster);
+				const int32 B = GetOrAddNode(T.To, ToCluster);
+
+				const FIntVector D = T.ToXYZ - T.FromXYZ;
+				const float Cost = OctileDistance(D.X, D.Y, D.Z);
+
+				AddEdgeOnce(G.NodeEdges[A], B, Cost);
+				AddEdgeOnce(G.NodeEdges[B], A, Cost);
+			}
+		}
+	}
+
+	// ---------------------------------------------------------------------
+	// 3. Link the nodes of each cluster with their path cost inside it
+	// ---------------------------------------------------------------------
+	FMGDNScopedSearchState Flood;
+	FMGDNSearchStats FloodStats;
+	TArray<int32> Targets;
+	int32 IntraEdges = 0;
+
+	for (int32 Cluster = 0; Cluster < NumClusters; ++Cluster)
+	{
+		const TArray<int32>& Nodes = G.ClusterNodes[Cluster];
+		if (Nodes.Num() < 2)
+			continue;
+
+		const FMGDNGridBounds Bounds = G.ClusterBounds(Cluster);
+
+		Targets.Reset();
+		for (const int32 Node : Nodes)
+		{
+			Targets.Add(G.NodeCell[Node]);
+		}
+
+		for (const int32 From : Nodes)
+		{
+			FloodCosts(G.NodeCell[From], Bounds, Targets, *Flood, FloodStats);
+
+			for (const int32 To : Nodes)
+			{
+				const int32 ToCell = G.NodeCell[To];
+				if (To == From || !Flood->IsClosed(ToCell))
+					continue;
+
+				AddEdgeOnce(G.NodeEdges[From], To, Flood->Records[ToCell].G);
+				IntraEdges++;
+			}
+		}
+	}
+
+	UE_LOG(LogTemp, Log,
+		TEXT("[MGDN] BuildClusterGraph OK Clusters=%d (%dx%dx%d) Size=%d Nodes=%d IntraEdges=%d"),
+		NumClusters, G.NumClusters.X, G.NumClusters.Y, G.NumClusters.Z, CS, G.NumNodes(), IntraEdges);
+}
+
+void UMGDNRuntimeNavMesh::FloodCosts(
+	int32 Source,
+	const FMGDNGridBounds& Bounds,
+	const TArray<int32>& Targets,
+	FMGDNSearchState& S,
+	FMGDNSearchStats& Stats) const
+{
+	S.Begin(NumCellIndices());
+
+	// Costs are final once a cell is closed, so stop when every target is
+	int32 Remaining = Targets.Num();
+
+	S.Visit(Source).G = 0.f;
+	S.Push(Source, 0.f);
+	Stats.Pushes++;
+
+	while (!S.IsOpenEmpty())
+	{
+		const int32 Current = S.Pop();
+		Stats.Expansions++;
+
+		if (Targets.Contains(Current) && --Remaining <= 0)
+			break;
+
+		const float CurrentG = S.Records[Current].G;
+
+		int32 CX, CY, CZ;
+		ToXYZ(Current, CX, CY, CZ);
+
+		uint32 Moves = ClipMoves(GetMoveMask(Current), CX, CY, CZ, Bounds);
+		while (Moves)
+		{
+			const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+			Moves &= Moves - 1;
+
+			const int32 NIndex = StepIndex(Current, CX, CY, CZ, Bit);
+			FMGDNCellRecord& N = S.Visit(NIndex);
+
+			if (N.HeapSlot == FMGDNSearchState::ClosedSlot)
+				continue;
+
+			const float NewG = CurrentG + MoveCost(Bit);
+
+			if (NewG < N.G)
+			{
+				N.G      = NewG;
+				N.Parent = Current;
+
+				S.Push(NIndex, NewG);
+				Stats.Pushes++;
+			}
+		}
+	}
+}
+
+bool UMGDNRuntimeNavMesh::HierarchicalSearch(
+	int32 Start,
+	int32 End,
+	TArray<int32>& OutIndices,
+	FMGDNSearchStats* OutStats) const
+{
+	OutIndices.Reset();
+
+	if (!ClusterGraph.IsBuilt())
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("[MGDN] HierarchicalSearch: No cluster graph, using A*"));
+		return AStar(Start, End, OutIndices, OutStats);
+	}
+
+	if (Start == End)
+	{
+		OutIndices.Add(Start);
+		return true;
+	}
+
+	const FMGDNClusterGraph& G = ClusterGraph;
+	FMGDNSearchStats Stats;
+
+	int32 SX, SY, SZ;
+	int32 EX, EY, EZ;
+	ToXYZ(Start, SX, SY, SZ);
+	ToXYZ(End, EX, EY, EZ);
+
+	const int32 StartCluster = G.ClusterOf(SX, SY, SZ);
+	const int32 EndCluster   = G.ClusterOf(EX, EY, EZ);
+
+	// Start and goal join the abstract graph as two extra nodes
+	const int32 NumNodes  = G.NumNodes();
+	const int32 StartNode = NumNodes;
+	const int32 EndNode   = NumNodes + 1;
+
+	auto CellOf = [&G, Start, End, StartNode, EndNode](int32 Node) -> int32
+	{
+		if (Node == StartNode) return Start;
+		if (Node == EndNode) return End;
+		return G.NodeCell[Node];
+	};
+
+	// ---------------------------------------------------------------------
+	// 1. Connect start and goal to the entrances of their clusters
+	// ---------------------------------------------------------------------
+	TArray<FMGDNClusterEdge> StartEdges;
+	TMap<int32, float> GoalCosts;
+
+	{
+		FMGDNScopedSearchState Flood;
+		TArray<int32> Targets;
+
+		for (const int32 Node : G.ClusterNodes[StartCluster])
+		{
+			Targets.Add(G.NodeCell[Node]);
+		}
+		if (StartCluster == EndCluster)
+		{
+			Targets.Add(End);
+		}
+
+		FloodCosts(Start, G.ClusterBounds(StartCluster), Targets, *Flood, Stats);
+
+		for (const int32 Node : G.ClusterNodes[StartCluster])
+		{
+			const int32 Cell = G.NodeCell[Node];
+			if (Flood->IsClosed(Cell))
+			{
+				FMGDNClusterEdge Edge;
+				Edge.To = Node;
+				Edge.Cost = Flood->Records[Cell].G;
+				StartEdges.Add(Edge);
+			}
+		}
+
+		if (StartCluster == EndCluster && Flood->IsClosed(End))
+		{
+			FMGDNClusterEdge Edge;
+			Edge.To = EndNode;
+			Edge.Cost = Flood->Records[End].G;
+			StartEdges.Add(Edge);
+		}
+
+		Targets.Reset();
+		for (const int32 Node : G.ClusterNodes[EndCluster])
+		{
+			Targets.Add(G.NodeCell[Node]);
+		}
+
+		FloodCosts(End, G.ClusterBounds(EndCluster), Targets, *Flood, Stats);
+
+		for (const int32 Node : G.ClusterNodes[EndCluster])
+		{
+			const int32 Cell = G.NodeCell[Node];
+			if (Flood->IsClosed(Cell))
+			{
+				GoalCosts.Add(Node, Flood->Records[Cell].G);
+			}
+		}
+	}
+
+	// ---------------------------------------------------------------------
+	// 2. A* over the abstract graph
+	// ---------------------------------------------------------------------
+	TArray<int32> AbstractPath;
+
+	{
+		FMGDNScopedSearchState Search;
+		FMGDNSearchState& S = *Search;
+		S.Begin(NumNodes + 2);
+
+		// Abstract edges cost at least the shortest grid path between their cells, so the landmark bound still holds
+		const FIntVector EndXYZ(EX, EY, EZ);
+		const float* EndCosts = GetLandmarkCosts(End);
+
+		auto Heuristic = [this, &CellOf, &EndXYZ, EndCosts](int32 Node) -> float
+		{
+			const int32 Cell = CellOf(Node);
+
+			int32 AX, AY, AZ;
+			ToXYZ(Cell, AX, AY, AZ);
+			return PathHeuristic(Cell, AX, AY, AZ, EndXYZ, EndCosts);
+		};
+
+		auto Relax = [&S, &Stats, &Heuristic](int32 From, int32 To, float NewG)
+		{
+			FMGDNCellRecord& N = S.Visit(To);
+
+			if (N.HeapSlot == FMGDNSearchState::ClosedSlot)
+				return;
+
+			if (NewG < N.G)
+			{
+				N.G      = NewG;
+				N.Parent = From;
+
+				const float H = Heuristic(To);
+				S.Push(To, NewG + H, H);
+				Stats.Pushes++;
+			}
+		};
+
+		S.Visit(StartNode).G = 0.f;
+		const float StartH = Heuristic(StartNode);
+		S.Push(StartNode, StartH, StartH);
+		Stats.Pushes++;
+
+		while (!S.IsOpenEmpty())
+		{
+			const int32 Current = S.Pop();
+			Stats.Expansions++;
+
+			if (Current == EndNode)
+			{
+				S.BuildPath(EndNode, AbstractPath);
+				break;
+			}
+
+			const float CurrentG = S.Records[Current].G;
+
+			if (Current == StartNode)
+			{
+				for (const FMGDNClusterEdge& E : StartEdges)
+					Relax(Current, E.To, CurrentG + E.Cost);
+				continue;
+			}
+
+			for (const FMGDNClusterEdge& E : G.NodeEdges[Current])
+				Relax(Current, E.To, CurrentG + E.Cost);
+
+			if (const float* ToGoal = GoalCosts.Find(Current))
+				Relax(Current, EndNode, CurrentG + *ToGoal);
+		}
+	}
+
+	bool bFound = AbstractPath.Num() > 0;
+
+	// ---------------------------------------------------------------------
+	// 3. Refine each abstract step inside its cluster
+	// ---------------------------------------------------------------------
+	if (bFound)
+	{
+		OutIndices.Add(Start);
+
+		TArray<int32> Segment;
+
+		for (int32 i = 1; i < AbstractPath.Num() && bFound; ++i)
+		{
+			const int32 FromCell = CellOf(AbstractPath[i - 1]);
+			const int32 ToCell   = CellOf(AbstractPath[i]);
+
+			if (FromCell == ToCell)
+				continue;
+
+			int32 FX, FY, FZ;
+			int32 TX, TY, TZ;
+			ToXYZ(FromCell, FX, FY, FZ);
+			ToXYZ(ToCell, TX, TY, TZ);
+
+			const int32 FromCluster = G.ClusterOf(FX, FY, FZ);
+
+			// Entrance crossing, the two cells are neighbours
+			if (FromCluster != G.ClusterOf(TX, TY, TZ))
+			{
+				OutIndices.Add(ToCell);
+				continue;
+			}
+
+			const FMGDNGridBounds Bounds = G.ClusterBounds(FromCluster);
+
+			FMGDNSearchStats SegmentStats;
+			bFound = AStar(FromCell, ToCell, Segment, &SegmentStats, &Bounds);
+			Stats += SegmentStats;
+
+			for (int32 k = 1; k < Segment.Num(); ++k)
+			{
+				OutIndices.Add(Segment[k]);
+			}
+		}
+
+		if (!bFound)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[MGDN] HierarchicalSearch: Refinement failed inside a cluster"));
+			OutIndices.Reset();
+		}
+	}
+
+	if (OutStats)
+	{
+		*OutStats = Stats;
+	}
+
+	return bFound;
+}
@@ -0,0 +1,526 @@
+﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
+#include "MGDNRuntimeNavMesh.h"
+#include "MGDNSearchState.h"
+#include "Algo/Reverse.h"
+
+// Incremental replanning with D* Lite.
+// The search runs backwards from the goal, so every settled cell holds its cost to the goal and the
+// agent's cell can move without invalidating anything. Rhs is each cell's best cost through its
+// current moves. Blocking or reopening cells changes Rhs only for them and their neighbours, and
+// only cells whose cost really changed are queued and expanded again. Keys carry the heuristic
+// towards the start the agent had when they were computed, later starts add the drift in KeyOffset
+// instead of requeueing the open list.
+// Following a moving target roots the same search at the agent instead (Moving Target D* Lite), so the
+// target is the end that moves for free. The agent walking its path keeps the old root, the rest of a
+// shortest path is still shortest. Once the path no longer passes the agent the root moves to it: cells
+// whose shortest route from the old root runs through the new one keep their costs less the cost of
+// reaching it, everything else is dropped and only its border with the kept cells is queued again.
+
+namespace
+{
+	// Primary D* Lite key in F, its cost part in H, so FMGDNHeapEntry::PopsBefore orders keys lexicographically
+	FORCEINLINE FMGDNHeapEntry IncrementalKey(int32 Cell, float G, float Rhs, float H, float KeyOffset)
+	{
+		FMGDNHeapEntry Key;
+		Key.Cell = Cell;
+		Key.H    = FMath::Min(G, Rhs);
+		Key.F    = Key.H == FLT_MAX ? FLT_MAX : Key.H + H + KeyOffset;
+		return Key;
+	}
+}
+
+FMGDNIncrementalPath::~FMGDNIncrementalPath()
+{
+	Reset();
+}
+
+void FMGDNIncrementalPath::Reset()
+{
+	FMGDNSearchStatePool::Release(State);
+	State = nullptr;
+
+	Start = INDEX_NONE;
+	Goal  = INDEX_NONE;
+	AgentRadius = 0.f;
+	Path.Reset();
+	Stats = FMGDNSearchStats();
+	Rhs.Empty();
+	Marks.Empty();
+	KeyStart     = INDEX_NONE;
+	KeyOffset    = 0.f;
+	NavVersion   = 0;
+	MinClearance = 0.f;
+}
+
+FMGDNCellRecord& FMGDNIncrementalPath::Visit(int32 Cell)
+{
+	if (!State->IsVisited(Cell))
+	{
+		Rhs[Cell] = FLT_MAX;
+	}
+	return State->Visit(Cell);
+}
+
+bool UMGDNRuntimeNavMesh::BeginIncrementalPath(int32 StartIndex, int32 GoalIndex, FMGDNIncrementalPath& Path, float AgentRadius) const
+{
+	Path.Start        = StartIndex;
+	Path.Goal         = GoalIndex;
+	Path.AgentRadius  = FMath::Max(AgentRadius, 0.f);
+	Path.MinClearance = RequiredClearance(Path.AgentRadius);
+	Path.NavVersion   = NavVersion;
+	Path.KeyStart     = StartIndex;
+	Path.KeyOffset    = 0.f;
+	Path.Path.Reset();
+	Path.Stats = FMGDNSearchStats();
+
+	if (!Walkable.IsValidIndex(StartIndex) || !Walkable.IsValidIndex(GoalIndex) ||
+		!IsOpen(StartIndex) || !IsOpen(GoalIndex) || !AreConnected(StartIndex, GoalIndex))
+	{
+		// Blocking never joins regions, nothing to keep until the next rebuild
+		FMGDNSearchStatePool::Release(Path.State);
+		Path.State = nullptr;
+		return false;
+	}
+
+	// Kept across restarts, a move that replans after a rebuild reuses its allocations
+	if (!Path.State)
+	{
+		Path.State = FMGDNSearchStatePool::Acquire();
+	}
+
+	const int32 Num = NumCellIndices();
+	Path.State->Begin(Num);
+	if (Path.Rhs.Num() < Num)
+	{
+		Path.Rhs.SetNumUninitialized(Num);
+	}
+
+	int32 SX, SY, SZ, GX, GY, GZ;
+	ToXYZ(StartIndex, SX, SY, SZ);
+	ToXYZ(GoalIndex, GX, GY, GZ);
+
+	Path.Visit(GoalIndex);
+	Path.Rhs[GoalIndex] = 0.f;
+
+	const FMGDNHeapEntry Key = IncrementalKey(GoalIndex, FLT_MAX, 0.f, OctileDistance(GX - SX, GY - SY, GZ - SZ), 0.f);
+	Path.State->Update(GoalIndex, Key.F, Key.H);
+	Path.Stats.Pushes++;
+
+	return ComputeIncrementalPath(Path);
+}
+
+bool UMGDNRuntimeNavMesh::ReplanIncrementalPath(FMGDNIncrementalPath& Path, int32 StartIndex) const
+{
+	TArray<int32> Changed;
+	if (!Path.State || !GetCellChangesSince(Path.NavVersion, Changed))
+		return BeginIncrementalPath(StartIndex, Path.Goal, Path, Path.AgentRadius);
+
+	Path.Start = StartIndex;
+	Path.NavVersion = NavVersion;
+	Path.Path.Reset();
+	Path.Stats = FMGDNSearchStats();
+
+	if (!Walkable.IsValidIndex(StartIndex) || !IsOpen(StartIndex) || !AreConnected(StartIndex, Path.Goal))
+		return false;
+
+	if (StartIndex != Path.KeyStart)
+	{
+		// Queued keys now overestimate by at most the distance the start moved, raising every new key
+		// by that much keeps the order without touching the queue
+		int32 AX, AY, AZ, BX, BY, BZ;
+		ToXYZ(Path.KeyStart, AX, AY, AZ);
+		ToXYZ(StartIndex, BX, BY, BZ);
+
+		Path.KeyOffset += OctileDistance(AX - BX, AY - BY, AZ - BZ);
+		Path.KeyStart = StartIndex;
+	}
+
+	FIntVector StartXYZ;
+	ToXYZ(StartIndex, StartXYZ.X, StartXYZ.Y, StartXYZ.Z);
+
+	for (const int32 Cell : Changed)
+	{
+		UpdateIncrementalCell(Path, Cell, StartXYZ);
+
+		// Moves into and out of the cell changed, baked moves cover both while it is blocked
+		int32 X, Y, Z;
+		ToXYZ(Cell, X, Y, Z);
+
+		uint32 Moves = GetBakedMoveMask(Cell);
+		while (Moves)
+		{
+			const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+			Moves &= Moves - 1;
+
+			UpdateIncrementalCell(Path, StepIndex(Cell, X, Y, Z, Bit), StartXYZ);
+		}
+	}
+
+	return ComputeIncrementalPath(Path);
+}
+
+float UMGDNRuntimeNavMesh::IncrementalRhs(FMGDNIncrementalPath& Path, int32 Cell) const
+{
+	const FMGDNSearchState& S = *Path.State;
+
+	int32 X, Y, Z;
+	ToXYZ(Cell, X, Y, Z);
+
+	float Best = FLT_MAX;
+
+	uint32 Moves = GetMoveMask(Cell);
+	while (Moves)
+	{
+		const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+		Moves &= Moves - 1;
+
+		const int32 NIndex = StepIndex(Cell, X, Y, Z, Bit);
+
+		if (!S.IsVisited(NIndex) || S.Records[NIndex].G == FLT_MAX)
+			continue;
+
+		if (NIndex != Path.Goal && !HasClearance(NIndex, Path.MinClearance))
+			continue;
+
+		Best = FMath::Min(Best, S.Records[NIndex].G + MoveCost(Bit));
+	}
+
+	return Best;
+}
+
+bool UMGDNRuntimeNavMesh::FollowIncrementalPath(FMGDNIncrementalPath& Path, int32 AgentIndex, int32 TargetIndex, float AgentRadius) const
+{
+	const float Radius = FMath::Max(AgentRadius, 0.f);
+
+	// Records of an older grid or another clearance are no use
+	const bool bFresh = !Path.State || Path.Goal == INDEX_NONE || Path.AgentRadius != Radius ||
+		Path.NavVersion < CellChangesFrom;
+
+	// Stats cover every step the call took
+	auto RerootAndReplan = [this, &Path, AgentIndex, TargetIndex, Radius]()
+	{
+		FMGDNSearchStats Spent = Path.Stats;
+		bool bFound = false;
+
+		if (RerootIncrementalPath(Path, AgentIndex))
+		{
+			Spent += Path.Stats;
+			bFound = ReplanIncrementalPath(Path, TargetIndex);
+		}
+		else
+		{
+			bFound = BeginIncrementalPath(TargetIndex, AgentIndex, Path, Radius);
+		}
+
+		Path.Stats += Spent;
+		return bFound;
+	};
+
+	bool bFound = false;
+	Path.Stats = FMGDNSearchStats();
+
+	if (bFresh)
+	{
+		bFound = BeginIncrementalPath(TargetIndex, AgentIndex, Path, Radius);
+	}
+	else if (AgentIndex != Path.Goal && !Path.Path.Contains(AgentIndex))
+	{
+		bFound = RerootAndReplan();
+	}
+	else
+	{
+		// An agent moving along its path keeps the old root, the rest of a shortest path is still shortest.
+		// Rerooting waits until the path no longer passes the agent, the target moving never needs it.
+		bFound = ReplanIncrementalPath(Path, TargetIndex);
+		if (bFound && !Path.Path.Contains(AgentIndex))
+		{
+			bFound = RerootAndReplan();
+		}
+	}
+
+	// Searched from the target end, the path starts at the root behind the agent once reversed
+	Algo::Reverse(Path.Path);
+	const int32 AgentAt = Path.Path.Find(AgentIndex);
+	if (AgentAt > 0)
+	{
+		Path.Path.RemoveAt(0, AgentAt);
+	}
+
+	return bFound;
+}
+
+bool UMGDNRuntimeNavMesh::RerootIncrementalPath(FMGDNIncrementalPath& Path, int32 NewGoal) const
+{
+	FMGDNSearchState& S = *Path.State;
+	Path.Stats = FMGDNSearchStats();
+
+	if (!Walkable.IsValidIndex(NewGoal) || !IsOpen(NewGoal) || !S.IsVisited(NewGoal) ||
+		S.Records[NewGoal].G == FLT_MAX || S.Records[NewGoal].G != Path.Rhs[NewGoal])
+		return false;
+
+	const int32 Num = NumCellIndices();
+	if (Path.Marks.Num() < Num)
+	{
+		Path.Marks.SetNumZeroed(Num);
+	}
+
+	// Costs from the new root are the old ones less the cost of reaching it
+	const float Offset = S.Records[NewGoal].G;
+
+	struct FKeptCell
+	{
+		int32 Cell;
+		float G;
+	};
+
+	// Settled cells one tight move past a kept cell have a shortest route through NewGoal, their costs stay exact.
+	// Grid paths tie a lot, so following moves instead of a single parent per cell keeps every tied route.
+	TArray<FKeptCell> KeptCells;
+	KeptCells.Add({ NewGoal, 0.f });
+	Path.Marks[NewGoal] = 1;
+
+	for (int32 i = 0; i < KeptCells.Num(); ++i)
+	{
+		const int32 Cell = KeptCells[i].Cell;
+		if (Cell != NewGoal && !HasClearance(Cell, Path.MinClearance))
+			continue;
+
+		const float G = S.Records[Cell].G;
+
+		int32 X, Y, Z;
+		ToXYZ(Cell, X, Y, Z);
+
+		uint32 Moves = GetMoveMask(Cell);
+		while (Moves)
+		{
+			const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+			Moves &= Moves - 1;
+
+			const int32 NIndex = StepIndex(Cell, X, Y, Z, Bit);
+			if (Path.Marks[NIndex] || !S.IsVisited(NIndex))
+				continue;
+
+			const float NG = S.Records[NIndex].G;
+			if (NG == FLT_MAX || NG != Path.Rhs[NIndex])
+				continue;
+
+			const float Expected = G + MoveCost(Bit);
+			if (FMath::Abs(NG - Expected) > KINDA_SMALL_NUMBER * FMath::Max(Expected, 1.f))
+				continue;
+
+			Path.Marks[NIndex] = 1;
+			KeptCells.Add({ NIndex, NG - Offset });
+		}
+	}
+
+	for (const FKeptCell& K : KeptCells)
+	{
+		Path.Marks[K.Cell] = 0;
+	}
+
+	// A new generation drops every other cell and empties the queue
+	S.Begin(Num);
+	Path.Goal      = NewGoal;
+	Path.KeyStart  = Path.Start;
+	Path.KeyOffset = 0.f;
+
+	for (const FKeptCell& K : KeptCells)
+	{
+		Path.Visit(K.Cell).G = K.G;
+		Path.Rhs[K.Cell] = K.G;
+	}
+
+	FIntVector StartXYZ;
+	ToXYZ(Path.Start, StartXYZ.X, StartXYZ.Y, StartXYZ.Z);
+
+	// Kept cells are all consistent, the dropped cells bordering them are queued with the costs they get from them
+	for (const FKeptCell& K : KeptCells)
+	{
+		if (K.Cell != NewGoal && !HasClearance(K.Cell, Path.MinClearance))
+			continue;
+
+		int32 X, Y, Z;
+		ToXYZ(K.Cell, X, Y, Z);
+
+		uint32 Moves = GetMoveMask(K.Cell);
+		while (Moves)
+		{
+			const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+			Moves &= Moves - 1;
+
+			const int32 NIndex = StepIndex(K.Cell, X, Y, Z, Bit);
+			if (!S.IsVisited(NIndex))
+			{
+				UpdateIncrementalCell(Path, NIndex, StartXYZ);
+			}
+		}
+	}
+
+	UE_LOG(LogTemp, Verbose,
+		TEXT("[MGDN] RerootIncrementalPath: Goal=%d Kept=%d Queued=%d"), NewGoal, KeptCells.Num(), S.Heap.Num());
+
+	return true;
+}
+
+void UMGDNRuntimeNavMesh::UpdateIncrementalCell(FMGDNIncrementalPath& Path, int32 Cell, const FIntVector& StartXYZ) const
+{
+	FMGDNSearchState& S = *Path.State;
+	const FMGDNCellRecord& R = Path.Visit(Cell);
+
+	if (Cell != Path.Goal)
+	{
+		Path.Rhs[Cell] = IncrementalRhs(Path, Cell);
+	}
+
+	if (R.G == Path.Rhs[Cell])
+	{
+		S.Remove(Cell);
+		return;
+	}
+
+	int32 X, Y, Z;
+	ToXYZ(Cell, X, Y, Z);
+
+	const FMGDNHeapEntry Key = IncrementalKey(Cell, R.G, Path.Rhs[Cell],
+		AStarHeuristic(X, Y, Z, StartXYZ), Path.KeyOffset);
+
+	S.Update(Cell, Key.F, Key.H);
+	Path.Stats.Pushes++;
+}
+
+bool UMGDNRuntimeNavMesh::ComputeIncrementalPath(FMGDNIncrementalPath& Path) const
+{
+	FMGDNSearchState& S = *Path.State;
+	const int32 Start = Path.Start;
+
+	FIntVector StartXYZ;
+	ToXYZ(Start, StartXYZ.X, StartXYZ.Y, StartXYZ.Z);
+
+	// Cells whose cost to the goal changed, for the neighbours that may move through them
+	auto UpdatePredecessors = [this, &Path, &StartXYZ](int32 Cell)
+	{
+		// A cell the agent does not fit through offers nothing to its neighbours
+		if (Cell != Path.Goal && !HasClearance(Cell, Path.MinClearance))
+			return;
+
+		int32 X, Y, Z;
+		ToXYZ(Cell, X, Y, Z);
+
+		// Moves are symmetric, the cells moving into this one are the cells it moves to
+		uint32 Moves = GetMoveMask(Cell);
+		while (Moves)
+		{
+			const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+			Moves &= Moves - 1;
+
+			UpdateIncrementalCell(Path, StepIndex(Cell, X, Y, Z, Bit), StartXYZ);
+		}
+	};
+
+	Path.Visit(Start);
+
+	while (!S.IsOpenEmpty())
+	{
+		const FMGDNCellRecord& StartRec = S.Records[Start];
+		const FMGDNHeapEntry StartKey = IncrementalKey(Start, StartRec.G, Path.Rhs[Start],
+			0.f, Path.KeyOffset);
+
+		FMGDNHeapEntry Top;
+		Top.F    = S.PeekF();
+		Top.H    = S.PeekH();
+		Top.Cell = S.PeekCell();
+
+		// Done once nothing queued could still lower the start's cost and the start is settled. Cells on a shortest
+		// path tie with the start's key, and float sums of equal keys land either side of it, so near ties still run.
+		const float Slack = KINDA_SMALL_NUMBER * FMath::Max(StartKey.F, 1.f);
+		if (Top.F - StartKey.F > Slack && StartRec.G == Path.Rhs[Start])
+			break;
+
+		const int32 Cell = Top.Cell;
+		FMGDNCellRecord& R = S.Records[Cell];
+
+		int32 X, Y, Z;
+		ToXYZ(Cell, X, Y, Z);
+
+		const FMGDNHeapEntry Key = IncrementalKey(Cell, R.G, Path.Rhs[Cell],
+			AStarHeuristic(X, Y, Z, StartXYZ), Path.KeyOffset);
+
+		// Queued under an older start, requeue with the current key first
+		if (Top.PopsBefore(Key))
+		{
+			S.Update(Cell, Key.F, Key.H);
+			continue;
+		}
+
+		Path.Stats.Expansions++;
+
+		if (R.G > Path.Rhs[Cell])
+		{
+			// Cheaper than before, settle it
+			R.G = Path.Rhs[Cell];
+			S.Remove(Cell);
+			UpdatePredecessors(Cell);
+		}
+		else
+		{
+			// Dearer than before, forget its cost and let it and its neighbours find a new one
+			R.G = FLT_MAX;
+			UpdateIncrementalCell(Path, Cell, StartXYZ);
+			UpdatePredecessors(Cell);
+		}
+	}
+
+	if (S.Records[Start].G == FLT_MAX)
+		return false;
+
+	// Settled costs lead downhill to the goal, each step takes the move with the lowest cost left
+	Path.Path.Add(Start);
+
+	int32 Index = Start;
+	while (Index != Path.Goal)
+	{
+		int32 X, Y, Z;
+		ToXYZ(Index, X, Y, Z);
+
+		int32 Best = INDEX_NONE;
+		float BestCost = FLT_MAX;
+
+		uint32 Moves = GetMoveMask(Index);
+		while (Moves)
+		{
+			const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+			Moves &= Moves - 1;
+
+			const int32 NIndex = StepIndex(Index, X, Y, Z, Bit);
+
+			if (!S.IsVisited(NIndex) || S.Records[NIndex].G == FLT_MAX)
+				continue;
+
+			if (NIndex != Path.Goal && !HasClearance(NIndex, Path.MinClearance))
+				continue;
+
+			const float Cost = S.Records[NIndex].G + MoveCost(Bit);
+			if (Cost < BestCost)
+			{
+				BestCost = Cost;
+				Best = NIndex;
+			}
+		}
+
+		if (Best == INDEX_NONE || Path.Path.Num() > Connectivity.Num())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[MGDN] ComputeIncrementalPath: Broken cost chain at %d"), Index);
+			Path.Path.Reset();
+			return false;
+		}
+
+		Path.Path.Add(Best);
+		Index = Best;
+	}
+
+	UE_LOG(LogTemp, Verbose,
+		TEXT("[MGDN] ComputeIncrementalPath: Start=%d Goal=%d Cells=%d Expansions=%d"),
+		Start, Path.Goal, Path.Path.Num(), Path.Stats.Expansions);
+
+	return true;
+}
@@ -0,0 +1,435 @@
+﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
+#include "MGDNRuntimeNavMesh.h"
+#include "MGDNSearchState.h"
+
+// Jump Point Search on the voxel grid.
+// Every deck layer is searched as an 8-connected 2D grid with the classic JPS pruning rules.
+// Moves that change Z cannot be pruned that way, so any cell with a ramp link to the layer
+// above or below is a jump stop and expands every move like plain A* does. The same goes
+// for cells around a move blocked by a height step, pruning assumes all walkable neighbours
+// are reachable. Path lengths stay the same as AStar, only symmetric expansions go away.
+
+namespace
+{
+	// Index into JumpDistances for a straight in-plane direction
+	FORCEINLINE int32 StraightDirIndex(int32 DX, int32 DY)
+	{
+		if (DX > 0) return 0;
+		if (DX < 0) return 1;
+		if (DY > 0) return 2;
+		return 3;
+	}
+}
+
+void UMGDNRuntimeNavMesh::BuildJumpStops()
+{
+	InitCellBits(JumpStops);
+
+	// Cells that can not step to every walkable cell beside them in their layer
+	TArray<FIntVector> Irregular;
+
+	for (int32 Z = 0; Z < GridZ; Z++)
+	for (int32 Y = 0; Y < GridY; Y++)
+	for (int32 X = 0; X < GridX; X++)
+	{
+		const int32 Index = ToIndex(X, Y, Z);
+		if (!Walkable[Index])
+			continue;
+
+		const uint32 Moves = GetMoveMask(Index);
+
+		if (Moves & FMGDNWalkableBits::VerticalBits)
+			JumpStops.Set(Index, true);
+
+		const uint32 Planar = GatherWalkableNeighbors(Index, X, Y, Z) & FMGDNWalkableBits::PlanarBits;
+		if (Planar & ~Moves)
+			Irregular.Add(FIntVector(X, Y, Z));
+	}
+
+	// Symmetric paths around an irregular cell may run through it, so nothing next to it is pruned
+	for (const FIntVector& C : Irregular)
+	{
+		for (int32 DY = -1; DY <= 1; DY++)
+			for (int32 DX = -1; DX <= 1; DX++)
+			{
+				if (IsWalkable(C.X + DX, C.Y + DY, C.Z))
+					JumpStops.Set(ToIndex(C.X + DX, C.Y + DY, C.Z), true);
+			}
+	}
+}
+
+void UMGDNRuntimeNavMesh::BuildJumpTable()
+{
+	JumpDistances.Reset();
+
+	if (GridX > MAX_int16 || GridY > MAX_int16)
+	{
+		UE_LOG(LogTemp, Warning,
+			TEXT("[MGDN] BuildJumpTable: Grid %dx%d too wide for jump distances, JPS will scan"),
+			GridX, GridY);
+		return;
+	}
+
+	JumpDistances.SetNumZeroed(NumCellIndices() * 4);
+
+	static const int32 DirX[4] = { 1, -1, 0,  0 };
+	static const int32 DirY[4] = { 0,  0, 1, -1 };
+
+	for (int32 Dir = 0; Dir < 4; ++Dir)
+	{
+		const int32 DX = DirX[Dir];
+		const int32 DY = DirY[Dir];
+
+		for (int32 Z = 0; Z < GridZ; Z++)
+		for (int32 IY = 0; IY < GridY; IY++)
+		for (int32 IX = 0; IX < GridX; IX++)
+		{
+			// Walk against the direction so the next cell along it is always resolved first
+			const int32 X = DX > 0 ? GridX - 1 - IX : IX;
+			const int32 Y = DY > 0 ? GridY - 1 - IY : IY;
+
+			const int32 Index = ToIndex(X, Y, Z);
+			if (!Walkable[Index])
+				continue;
+
+			const int32 NX = X + DX;
+			const int32 NY = Y + DY;
+
+			int16 Dist = 0;
+			if (IsWalkable(NX, NY, Z))
+			{
+				if (IsJumpPoint(NX, NY, Z, DX, DY))
+				{
+					Dist = 1;
+				}
+				else
+				{
+					const int16 Next = JumpDistances[ToIndex(NX, NY, Z) * 4 + Dir];
+					Dist = Next > 0 ? Next + 1 : Next - 1;
+				}
+			}
+
+			JumpDistances[Index * 4 + Dir] = Dist;
+		}
+	}
+}
+
+bool UMGDNRuntimeNavMesh::IsJumpPoint(int32 X, int32 Y, int32 Z, int32 DX, int32 DY) const
+{
+	// Deck changes and height steps are never pruned, the search has to stop here to consider them
+	if (JumpStops[ToIndex(X, Y, Z)])
+		return true;
+
+	// Forced neighbours, a blocked cell beside the move hides a path the parent can not take itself
+	if (DX != 0 && DY != 0)
+	{
+		return (IsWalkable(X - DX, Y + DY, Z) && !IsWalkable(X - DX, Y, Z)) ||
+			   (IsWalkable(X + DX, Y - DY, Z) && !IsWalkable(X, Y - DY, Z));
+	}
+
+	if (DX != 0)
+	{
+		return (IsWalkable(X + DX, Y + 1, Z) && !IsWalkable(X, Y + 1, Z)) ||
+			   (IsWalkable(X + DX, Y - 1, Z) && !IsWalkable(X, Y - 1, Z));
+	}
+
+	return (IsWalkable(X + 1, Y + DY, Z) && !IsWalkable(X + 1, Y, Z)) ||
+		   (IsWalkable(X - 1, Y + DY, Z) && !IsWalkable(X - 1, Y, Z));
+}
+
+int32 UMGDNRuntimeNavMesh::JumpStraight(
+	int32 X, int32 Y, int32 Z,
+	int32 DX, int32 DY,
+	int32 End, const FIntVector& EndXYZ) const
+{
+	if (JumpDistances.Num() > 0)
+	{
+		const int32 Dist = JumpDistances[ToIndex(X, Y, Z) * 4 + StraightDirIndex(DX, DY)];
+
+		// Goal lying on the ray before the jump point or wall ends the jump early
+		if (EndXYZ.Z == Z)
+		{
+			int32 GoalDist = 0;
+			if (DX != 0 && EndXYZ.Y == Y)
+				GoalDist = (EndXYZ.X - X) * DX;
+			else if (DY != 0 && EndXYZ.X == X)
+				GoalDist = (EndXYZ.Y - Y) * DY;
+
+			if (GoalDist > 0 && GoalDist <= FMath::Abs(Dist))
+				return End;
+		}
+
+		if (Dist > 0)
+			return ToIndex(X + DX * Dist, Y + DY * Dist, Z);
+
+		return INDEX_NONE;
+	}
+
+	for (;;)
+	{
+		X += DX;
+		Y += DY;
+
+		if (!IsWalkable(X, Y, Z))
+			return INDEX_NONE;
+
+		const int32 Index = ToIndex(X, Y, Z);
+		if (Index == End || IsJumpPoint(X, Y, Z, DX, DY))
+			return Index;
+	}
+}
+
+int32 UMGDNRuntimeNavMesh::Jump(
+	int32 X, int32 Y, int32 Z,
+	int32 DX, int32 DY,
+	int32 End, const FIntVector& EndXYZ) const
+{
+	// Only the first step can be height-blocked, cells passed afterwards are no jump stops
+	if (!CanMove(ToIndex(X, Y, Z), DX, DY, 0))
+		return INDEX_NONE;
+
+	if (DX == 0 || DY == 0)
+		return JumpStraight(X, Y, Z, DX, DY, End, EndXYZ);
+
+	for (;;)
+	{
+		X += DX;
+		Y += DY;
+
+		if (!IsWalkable(X, Y, Z))
+			return INDEX_NONE;
+
+		const int32 Index = ToIndex(X, Y, Z);
+		if (Index == End || IsJumpPoint(X, Y, Z, DX, DY))
+			return Index;
+
+		// Diagonal cell is a turning point when one of its straight components finds something
+		if (JumpStraight(X, Y, Z, DX, 0, End, EndXYZ) != INDEX_NONE ||
+			JumpStraight(X, Y, Z, 0, DY, End, EndXYZ) != INDEX_NONE)
+		{
+			return Index;
+		}
+	}
+}
+
+void UMGDNRuntimeNavMesh::AddJumpSuccessors(int32 Index, int32 ParentIndex, int32 End, TArray<int32>& Out) const
+{
+	Out.Reset();
+
+	int32 X, Y, Z;
+	ToXYZ(Index, X, Y, Z);
+
+	FIntVector EndXYZ;
+	ToXYZ(End, EndXYZ.X, EndXYZ.Y, EndXYZ.Z);
+
+	// Direction of travel in this layer, zero for the start and after a deck change
+	int32 PDX = 0;
+	int32 PDY = 0;
+
+	if (ParentIndex != INDEX_NONE)
+	{
+		int32 PX, PY, PZ;
+		ToXYZ(ParentIndex, PX, PY, PZ);
+
+		if (PZ == Z)
+		{
+			PDX = FMath::Sign(X - PX);
+			PDY = FMath::Sign(Y - PY);
+		}
+	}
+
+	int32 DirX[8];
+	int32 DirY[8];
+	int32 NumDirs = 0;
+
+	auto AddDir = [&](int32 DX, int32 DY)
+	{
+		DirX[NumDirs] = DX;
+		DirY[NumDirs] = DY;
+		NumDirs++;
+	};
+
+	if ((PDX == 0 && PDY == 0) || JumpStops[Index])
+	{
+		for (int32 DY = -1; DY <= 1; DY++)
+			for (int32 DX = -1; DX <= 1; DX++)
+			{
+				if (DX != 0 || DY != 0)
+					AddDir(DX, DY);
+			}
+	}
+	else if (PDX != 0 && PDY != 0)
+	{
+		AddDir(PDX, 0);
+		AddDir(0, PDY);
+		AddDir(PDX, PDY);
+
+		if (!IsWalkable(X - PDX, Y, Z))
+			AddDir(-PDX, PDY);
+		if (!IsWalkable(X, Y - PDY, Z))
+			AddDir(PDX, -PDY);
+	}
+	else if (PDX != 0)
+	{
+		AddDir(PDX, 0);
+
+		if (!IsWalkable(X, Y + 1, Z))
+			AddDir(PDX, 1);
+		if (!IsWalkable(X, Y - 1, Z))
+			AddDir(PDX, -1);
+	}
+	else
+	{
+		AddDir(0, PDY);
+
+		if (!IsWalkable(X + 1, Y, Z))
+			AddDir(1, PDY);
+		if (!IsWalkable(X - 1, Y, Z))
+			AddDir(-1, PDY);
+	}
+
+	for (int32 i = 0; i < NumDirs; ++i)
+	{
+		const int32 JumpIndex = Jump(X, Y, Z, DirX[i], DirY[i], End, EndXYZ);
+		if (JumpIndex != INDEX_NONE)
+			Out.Add(JumpIndex);
+	}
+
+	// Deck changes are expanded like A* does
+	uint32 Vertical = GetMoveMask(Index) & FMGDNWalkableBits::VerticalBits;
+	while (Vertical)
+	{
+		const int32 Bit = int32(FMath::CountTrailingZeros(Vertical));
+		Vertical &= Vertical - 1;
+
+		Out.Add(StepIndex(Index, X, Y, Z, Bit));
+	}
+}
+
+void UMGDNRuntimeNavMesh::ExpandJumpPath(const TArray<int32>& JumpPoints, TArray<int32>& OutIndices) const
+{
+	OutIndices.Reset();
+
+	if (JumpPoints.Num() == 0)
+		return;
+
+	OutIndices.Add(JumpPoints[0]);
+
+	// Consecutive jump points are always joined by a straight or diagonal line
+	for (int32 i = 1; i < JumpPoints.Num(); ++i)
+	{
+		int32 X, Y, Z;
+		int32 NX, NY, NZ;
+		ToXYZ(JumpPoints[i - 1], X, Y, Z);
+		ToXYZ(JumpPoints[i], NX, NY, NZ);
+
+		while (X != NX || Y != NY || Z != NZ)
+		{
+			X += FMath::Sign(NX - X);
+			Y += FMath::Sign(NY - Y);
+			Z += FMath::Sign(NZ - Z);
+
+			OutIndices.Add(ToIndex(X, Y, Z));
+		}
+	}
+}
+
+bool UMGDNRuntimeNavMesh::JumpPointSearch(int32 Start, int32 End, TArray<int32>& OutIndices, FMGDNSearchStats* OutStats,
+                                          float HeuristicWeight) const
+{
+	OutIndices.Reset();
+
+	if (Start == End)
+	{
+		OutIndices.Add(Start);
+		return true;
+	}
+
+	const int32 Num = NumCellIndices();
+	if (Num <= 0)
+		return false;
+
+	FMGDNScopedSearchState Search;
+	FMGDNSearchState& S = *Search;
+	S.Begin(Num);
+
+	FIntVector EndXYZ;
+	ToXYZ(End, EndXYZ.X, EndXYZ.Y, EndXYZ.Z);
+	const float* EndCosts = GetLandmarkCosts(End);
+
+	auto Heuristic = [this, &EndXYZ, EndCosts](int32 A) -> float
+	{
+		int32 AX, AY, AZ;
+		ToXYZ(A, AX, AY, AZ);
+		return PathHeuristic(A, AX, AY, AZ, EndXYZ, EndCosts);
+	};
+
+	FMGDNSearchStats Stats;
+
+	FMGDNCellRecord& StartRec = S.Visit(Start);
+	StartRec.G = 0.f;
+	const float StartH = Heuristic(Start);
+	S.Push(Start, HeuristicWeight * StartH, StartH);
+	Stats.Pushes++;
+
+	TArray<int32> Successors;
+	Successors.Reserve(26);
+
+	bool bFound = false;
+
+	while (!S.IsOpenEmpty())
+	{
+		const int32 Current = S.Pop();
+		Stats.Expansions++;
+
+		if (Current == End)
+		{
+			TArray<int32> JumpPoints;
+			S.BuildPath(End, JumpPoints);
+			ExpandJumpPath(JumpPoints, OutIndices);
+			bFound = true;
+			break;
+		}
+
+		const FMGDNCellRecord& CurRec = S.Records[Current];
+		const float CurrentG = CurRec.G;
+
+		AddJumpSuccessors(Current, CurRec.Parent, End, Successors);
+
+		int32 CX, CY, CZ;
+		ToXYZ(Current, CX, CY, CZ);
+
+		for (int32 NIndex : Successors)
+		{
+			FMGDNCellRecord& N = S.Visit(NIndex);
+
+			if (N.HeapSlot == FMGDNSearchState::ClosedSlot)
+				continue;
+
+			int32 NX, NY, NZ;
+			ToXYZ(NIndex, NX, NY, NZ);
+
+			// A jump runs along one move direction, so its cost is the octile distance it covers
+			const float JumpCost = OctileDistance(NX - CX, NY - CY, NZ - CZ);
+
+			const float NewG = CurrentG + JumpCost;
+
+			if (NewG < N.G)
+			{
+				N.G      = NewG;
+				N.Parent = Current;
+
+				const float H = Heuristic(NIndex);
+				S.Push(NIndex, NewG + HeuristicWeight * H, H);
+				Stats.Pushes++;
+			}
+		}
+	}
+
+	if (OutStats)
+	{
+		*OutStats = Stats;
+	}
+
+	return bFound;
+}
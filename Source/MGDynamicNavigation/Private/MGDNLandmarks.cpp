@@ -0,0 +1,165 @@
+﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
+#include "MGDNRuntimeNavMesh.h"
+#include "MGDNSearchState.h"
+
+// Landmark (ALT) heuristic.
+// A Dijkstra search from each landmark stores its path cost to every cell of the landmark's region.
+// Moves are symmetric, so for any cells N and T and landmark L the triangle inequality gives
+// cost(N, T) >= |cost(L, T) - cost(L, N)|. The largest of these bounds over all landmarks never
+// overestimates, stays consistent, and unlike the octile distance it sees the detour around a
+// bulkhead whenever a landmark sits behind it. Landmarks are picked farthest first, each one the
+// cell furthest from all earlier ones, which spreads them over the ends of the ship.
+// Costs are taken over the baked moves. Blocked cells and clearance limits only make paths longer,
+// so the bound still holds for every query.
+
+void UMGDNRuntimeNavMesh::BuildLandmarks()
+{
+	Landmarks.Reset();
+	LandmarkCosts.Reset();
+	LandmarkComponent = INDEX_NONE;
+
+	const int32 NumWalkable = Connectivity.Num();
+	if (NumLandmarks <= 0 || NumWalkable == 0)
+		return;
+
+	// Small regions are cheap to search without help, all landmarks go to the largest one
+	TArray<int32> ComponentSizes;
+	ComponentSizes.Init(0, NumComponents);
+	for (const int32 Component : Components)
+	{
+		ComponentSizes[Component]++;
+	}
+
+	LandmarkComponent = 0;
+	for (int32 i = 1; i < NumComponents; ++i)
+	{
+		if (ComponentSizes[i] > ComponentSizes[LandmarkComponent])
+			LandmarkComponent = i;
+	}
+
+	// Cell index of every rank, ranks of the region are the only ones searched
+	TArray<int32> RankCells;
+	RankCells.SetNumUninitialized(NumWalkable);
+
+	const int32 Num = NumCellIndices();
+	for (int32 Index = 0, Rank = 0; Index < Num; ++Index)
+	{
+		if (Walkable[Index])
+			RankCells[Rank++] = Index;
+	}
+
+	FMGDNScopedSearchState Search;
+	FMGDNSearchState& S = *Search;
+
+	// Dijkstra from Source over its region into Costs by rank, returns the rank furthest away
+	TArray<float> Costs;
+	auto Flood = [this, &S, &Costs](int32 Source)
+	{
+		S.Begin(NumCellIndices());
+		S.Visit(Source).G = 0.f;
+		S.Push(Source, 0.f);
+
+		int32 Farthest = Walkable.Rank(Source);
+
+		while (!S.IsOpenEmpty())
+		{
+			const int32 Current = S.Pop();
+			const float CurrentG = S.Records[Current].G;
+
+			const int32 Rank = Walkable.Rank(Current);
+			Costs[Rank] = CurrentG;
+			Farthest = Rank;
+
+			int32 CX, CY, CZ;
+			ToXYZ(Current, CX, CY, CZ);
+
+			uint32 Moves = GetMoveMask(Current);
+			while (Moves)
+			{
+				const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+				Moves &= Moves - 1;
+
+				const int32 NIndex = StepIndex(Current, CX, CY, CZ, Bit);
+				FMGDNCellRecord& N = S.Visit(NIndex);
+
+				if (N.HeapSlot == FMGDNSearchState::ClosedSlot)
+					continue;
+
+				const float NewG = CurrentG + MoveCost(Bit);
+				if (NewG < N.G)
+				{
+					N.G = NewG;
+					S.Push(NIndex, NewG);
+				}
+			}
+		}
+
+		return Farthest;
+	};
+
+	int32 Seed = INDEX_NONE;
+	for (int32 Rank = 0; Rank < NumWalkable && Seed == INDEX_NONE; ++Rank)
+	{
+		if (Components[Rank] == LandmarkComponent)
+			Seed = RankCells[Rank];
+	}
+
+	// The first landmark is the cell furthest from an arbitrary one, which lands at one end of the region
+	Costs.Init(0.f, NumWalkable);
+	int32 Next = Flood(Seed);
+
+	// Cost from each cell to its closest landmark so far, the next landmark is where this is largest
+	TArray<float> Nearest;
+	Nearest.Init(FLT_MAX, NumWalkable);
+
+	TArray<TArray<float>> Tables;
+
+	while (Tables.Num() < NumLandmarks)
+	{
+		Landmarks.Add(RankCells[Next]);
+		Flood(RankCells[Next]);
+
+		int32 Best = INDEX_NONE;
+		float BestCost = 0.f;
+
+		for (int32 Rank = 0; Rank < NumWalkable; ++Rank)
+		{
+			if (Components[Rank] != LandmarkComponent)
+				continue;
+
+			Nearest[Rank] = FMath::Min(Nearest[Rank], Costs[Rank]);
+			if (Nearest[Rank] > BestCost)
+			{
+				BestCost = Nearest[Rank];
+				Best = Rank;
+			}
+		}
+
+		Tables.Add(Costs);
+
+		// Every cell is a landmark already, a region smaller than NumLandmarks
+		if (Best == INDEX_NONE)
+			break;
+
+		Next = Best;
+	}
+
+	// Interleaved per cell, a heuristic reads one cell's costs for every landmark from one row
+	const int32 K = Landmarks.Num();
+	LandmarkCosts.SetNumZeroed(NumWalkable * K);
+
+	for (int32 Rank = 0; Rank < NumWalkable; ++Rank)
+	{
+		if (Components[Rank] != LandmarkComponent)
+			continue;
+
+		for (int32 i = 0; i < K; ++i)
+		{
+			LandmarkCosts[Rank * K + i] = Tables[i][Rank];
+		}
+	}
+
+	UE_LOG(LogTemp, Log,
+		TEXT("[MGDN] BuildLandmarks OK Landmarks=%d Region=%d/%d cells (%d bytes)"),
+		K, ComponentSizes[LandmarkComponent], NumWalkable, int32(LandmarkCosts.GetAllocatedSize()));
+}
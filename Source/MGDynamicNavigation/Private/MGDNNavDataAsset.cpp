@@ -1,3 +1,119 @@
 ﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
 #include "MGDNNavDataAsset.h"
 
+
+const FMGDNGridNode* UMGDNNavDataAsset::FindNode(int32 X, int32 Y, int32 Z) const
+{
+	if (!IsValid(X, Y, Z))
+		return nullptr;
+
+	if (!IsSparse())
+	{
+		const int32 Id = Index(X, Y, Z);
+		return Nodes.IsValidIndex(Id) ? &Nodes[Id] : nullptr;
+	}
+
+	const int32 Column = X + Y * GridX;
+
+	for (int32 i = ColumnSpans[Column]; i < ColumnSpans[Column + 1]; ++i)
+	{
+		const FMGDNColumnSpan& Span = Spans[i];
+
+		if (Z >= Span.MinZ && Z < Span.MinZ + Span.NumCells)
+			return &SpanNodes[Span.FirstNode + Z - Span.MinZ];
+	}
+
+	return nullptr;
+}
+
+void UMGDNNavDataAsset::SetSpansFromDense(const TArray<FMGDNGridNode>& DenseNodes)
+{
+	Nodes.Empty();
+	ColumnSpans.Reset();
+	Spans.Reset();
+	SpanNodes.Reset();
+
+	if (DenseNodes.Num() != GridX * GridY * GridZ)
+	{
+		UE_LOG(LogTemp, Error,
+			TEXT("[MGDN] SetSpansFromDense: Node count mismatch Nodes=%d Expected=%d"),
+			DenseNodes.Num(), GridX * GridY * GridZ);
+		return;
+	}
+
+	const int32 XYCount = GridX * GridY;
+	ColumnSpans.SetNumUninitialized(XYCount + 1);
+
+	for (int32 Column = 0; Column < XYCount; ++Column)
+	{
+		ColumnSpans[Column] = Spans.Num();
+
+		for (int32 Z = 0; Z < GridZ; ++Z)
+		{
+			const FMGDNGridNode& Node = DenseNodes[Column + Z * XYCount];
+			if (!Node.bWalkable)
+				continue;
+
+			// Extend the open span when this cell sits right on top of it
+			const bool bExtend = Spans.Num() > ColumnSpans[Column] &&
+				Spans.Last().MinZ + Spans.Last().NumCells == Z;
+
+			if (bExtend)
+			{
+				Spans.Last().NumCells++;
+			}
+			else
+			{
+				FMGDNColumnSpan Span;
+				Span.MinZ      = int16(Z);
+				Span.NumCells  = 1;
+				Span.FirstNode = SpanNodes.Num();
+				Spans.Add(Span);
+			}
+
+			SpanNodes.Add(Node);
+		}
+	}
+
+	ColumnSpans[XYCount] = Spans.Num();
+}
+
+void UMGDNNavDataAsset::SetNodesFromDense(const TArray<FMGDNGridNode>& DenseNodes)
+{
+	ColumnSpans.Empty();
+	Spans.Empty();
+	SpanNodes.Empty();
+
+	// Fresh nodes, so layout padding never keeps data from an older bake
+	Nodes.Reset();
+	Nodes.SetNum(NumIndices());
+
+	if (DenseNodes.Num() != GridX * GridY * GridZ)
+	{
+		UE_LOG(LogTemp, Error,
+			TEXT("[MGDN] SetNodesFromDense: Node count mismatch Nodes=%d Expected=%d"),
+			DenseNodes.Num(), GridX * GridY * GridZ);
+		return;
+	}
+
+	for (int32 Z = 0; Z < GridZ; Z++)
+	for (int32 Y = 0; Y < GridY; Y++)
+	for (int32 X = 0; X < GridX; X++)
+	{
+		Nodes[Index(X, Y, Z)] = DenseNodes[X + Y * GridX + Z * (GridX * GridY)];
+	}
+}
+
+int32 UMGDNNavDataAsset::CountWalkable() const
+{
+	if (IsSparse())
+		return SpanNodes.Num();
+
+	int32 Count = 0;
+	for (const FMGDNGridNode& Node : Nodes)
+	{
+		if (Node.bWalkable)
+			Count++;
+	}
+	return Count;
+}
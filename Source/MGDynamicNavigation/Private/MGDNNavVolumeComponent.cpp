@@ -28,10 +28,7 @@ void UMGDNNavVolumeComponent::OnRegister()
 
 	if (SourceAsset)
 	{
-		if (!RuntimeNav)
-			RuntimeNav = NewObject<UMGDNRuntimeNavMesh>(this, UMGDNRuntimeNavMesh::StaticClass(), NAME_None, RF_Transient);
-
-		RuntimeNav->BuildFromAsset(SourceAsset);
+		BuildRuntimeNav();
 	}
 
 	if (UWorld* World = GetWorld())
@@ -56,16 +53,244 @@ void UMGDNNavVolumeComponent::OnUnregister()
 	Super::OnUnregister();
 }
 
+bool UMGDNNavVolumeComponent::BuildRuntimeNav()
+{
+	if (!SourceAsset)
+		return false;
+
+	if (!RuntimeNav)
+		RuntimeNav = NewObject<UMGDNRuntimeNavMesh>(this, UMGDNRuntimeNavMesh::StaticClass(), NAME_None, RF_Transient);
+
+	// Queued path requests may be searching any of these navs on worker threads
+	if (UWorld* World = GetWorld())
+	{
+		if (auto* S = World->GetSubsystem<UMGDynamicNavigationSubsystem>())
+		{
+			S->WaitForPathRequests(RuntimeNav);
+
+			for (const UMGDNRuntimeNavMesh* LayerNav : LayerNavs)
+			{
+				S->WaitForPathRequests(LayerNav);
+			}
+		}
+	}
+
+	const int32 NumLayers = SourceAsset->AgentLayers.Num();
+	LayerNavs.SetNum(NumLayers);
+
+	auto Build = [this](UMGDNRuntimeNavMesh* Nav, const UMGDNNavDataAsset* Asset)
+	{
+		Nav->DefaultSearchMode = SearchMode;
+		Nav->ClusterSize = ClusterSize;
+		Nav->NumLandmarks = NumLandmarks;
+		Nav->MaxStepHeight = MaxStepHeight;
+
+		return Nav->BuildFromAsset(Asset);
+	};
+
+	for (int32 i = 0; i < NumLayers; ++i)
+	{
+		if (!LayerNavs[i])
+			LayerNavs[i] = NewObject<UMGDNRuntimeNavMesh>(this, UMGDNRuntimeNavMesh::StaticClass(), NAME_None, RF_Transient);
+
+		// A layer that fails to build is left out, GetRuntimeNavFor skips empty entries
+		if (!SourceAsset->AgentLayers[i] || !Build(LayerNavs[i], SourceAsset->AgentLayers[i]))
+			LayerNavs[i] = nullptr;
+	}
+
+	const bool bBuilt = Build(RuntimeNav, SourceAsset);
+
+	// Navs keep their obstacles across rebuilds, but layers created since start without any. RuntimeNav holds every
+	// applied obstacle, queued ones reach all grids together in ApplyQueuedObstacles.
+	for (UMGDNRuntimeNavMesh* LayerNav : LayerNavs)
+	{
+		if (!LayerNav)
+			continue;
+
+		for (const TPair<int32, FMGDNObstacle>& Pair : RuntimeNav->GetObstacles())
+		{
+			if (!LayerNav->FindObstacle(Pair.Key))
+			{
+				LayerNav->SetObstacle(Pair.Key, Pair.Value.LocalTransform, Pair.Value.Extent);
+			}
+		}
+	}
+
+	return bBuilt;
+}
+
+UMGDNRuntimeNavMesh* UMGDNNavVolumeComponent::GetRuntimeNavFor(float AgentRadius, float AgentHeight) const
+{
+	UMGDNRuntimeNavMesh* Best = nullptr;
+	const UMGDNNavDataAsset* BestLayer = nullptr;
+
+	if (SourceAsset)
+	{
+		for (int32 i = 0; i < LayerNavs.Num() && i < SourceAsset->AgentLayers.Num(); ++i)
+		{
+			const UMGDNNavDataAsset* Layer = SourceAsset->AgentLayers[i];
+			UMGDNRuntimeNavMesh* Nav = LayerNavs[i];
+
+			if (!Layer || !Nav || !Layer->FitsAgent(AgentRadius, AgentHeight))
+				continue;
+
+			// Layers baked for bigger capsules close ducts and narrow doors, the closest fit keeps them open
+			const bool bCloser = !BestLayer || Layer->AgentRadius < BestLayer->AgentRadius ||
+				(Layer->AgentRadius == BestLayer->AgentRadius && Layer->AgentHeight < BestLayer->AgentHeight);
+
+			if (bCloser)
+			{
+				Best = Nav;
+				BestLayer = Layer;
+			}
+		}
+	}
+
+	return Best ? Best : RuntimeNav;
+}
+
+int32 UMGDNNavVolumeComponent::AddObstacle(const FTransform& LocalTransform, const FVector& Extent)
+{
+	const int32 ObstacleId = NextObstacleId++;
+	ApplyObstacle(ObstacleId, &LocalTransform, Extent);
+	return ObstacleId;
+}
+
+void UMGDNNavVolumeComponent::MoveObstacle(int32 ObstacleId, const FTransform& LocalTransform, const FVector& Extent)
+{
+	ApplyObstacle(ObstacleId, &LocalTransform, Extent);
+}
+
+void UMGDNNavVolumeComponent::RemoveObstacle(int32 ObstacleId)
+{
+	ApplyObstacle(ObstacleId, nullptr, FVector::ZeroVector);
+}
+
+void UMGDNNavVolumeComponent::ApplyObstacle(int32 ObstacleId, const FTransform* LocalTransform, const FVector& Extent)
+{
+	// Latest change wins, a box that slid twice before the queue drained is stamped once
+	FMGDNQueuedObstacle& Change = QueuedObstacles.FindOrAdd(ObstacleId);
+	Change.bRemove        = LocalTransform == nullptr;
+	Change.LocalTransform = LocalTransform ? *LocalTransform : FTransform::Identity;
+	Change.Extent         = Extent;
+
+	ApplyQueuedObstacles();
+}
+
+void UMGDNNavVolumeComponent::ApplyQueuedObstacles()
+{
+	if (QueuedObstacles.Num() == 0)
+		return;
+
+	// Workers read the moves an obstacle changes. Instead of stalling the game thread on them, changes to cells wait
+	// for a tick without worker searches on these grids, and the subsystem holds new ones back until then
+	bool bSearching = false;
+	if (const UMGDynamicNavigationSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UMGDynamicNavigationSubsystem>() : nullptr)
+	{
+		bSearching = Subsystem->HasRunningPathRequests(RuntimeNav);
+
+		for (const UMGDNRuntimeNavMesh* LayerNav : LayerNavs)
+		{
+			bSearching = bSearching || Subsystem->HasRunningPathRequests(LayerNav);
+		}
+	}
+
+	auto Apply = [](UMGDNRuntimeNavMesh* Nav, int32 ObstacleId, const FMGDNQueuedObstacle& Change)
+	{
+		if (!Nav)
+			return;
+
+		if (Change.bRemove)
+			Nav->RemoveObstacle(ObstacleId);
+		else
+			Nav->SetObstacle(ObstacleId, Change.LocalTransform, Change.Extent);
+	};
+
+	for (auto It = QueuedObstacles.CreateIterator(); It; ++It)
+	{
+		// A box sliding inside its cells changes no moves, it never waits
+		if (bSearching && ChangesCells(It.Key(), It.Value()))
+			continue;
+
+		Apply(RuntimeNav, It.Key(), It.Value());
+
+		for (UMGDNRuntimeNavMesh* LayerNav : LayerNavs)
+		{
+			Apply(LayerNav, It.Key(), It.Value());
+		}
+
+		It.RemoveCurrent();
+	}
+}
+
+bool UMGDNNavVolumeComponent::ChangesCells(int32 ObstacleId, const FMGDNQueuedObstacle& Change) const
+{
+	auto Changes = [&](const UMGDNRuntimeNavMesh* Nav)
+	{
+		if (!Nav)
+			return false;
+
+		TArray<int32> Cells;
+		if (!Change.bRemove)
+		{
+			Nav->GatherObstacleCells(Change.LocalTransform, Change.Extent, Cells);
+		}
+
+		const FMGDNObstacle* Current = Nav->FindObstacle(ObstacleId);
+		return Cells != (Current ? Current->Cells : TArray<int32>());
+	};
+
+	if (Changes(RuntimeNav))
+		return true;
+
+	for (const UMGDNRuntimeNavMesh* LayerNav : LayerNavs)
+	{
+		if (Changes(LayerNav))
+			return true;
+	}
+
+	return false;
+}
+
 void UMGDNNavVolumeComponent::BakeNow()
 {
 #if WITH_EDITOR
     if (!SourceAsset) return;
 
+    if (!BakeGrid(SourceAsset, CellSize, CellHeight, 0.f, 0.f))
+        return;
+
+    // Layers stay sub-objects of the asset, kept across bakes so only their cells change
+    SourceAsset->AgentLayers.SetNum(AgentLayers.Num());
+
+    for (int32 i = 0; i < AgentLayers.Num(); ++i)
+    {
+        const FMGDNAgentLayerSettings& Settings = AgentLayers[i];
+        UMGDNNavDataAsset*& Layer = SourceAsset->AgentLayers[i];
+
+        if (!Layer)
+            Layer = NewObject<UMGDNNavDataAsset>(SourceAsset, NAME_None, RF_Transactional);
+
+        BakeGrid(Layer, Settings.CellSize, Settings.CellHeight, Settings.AgentRadius, Settings.AgentHeight);
+    }
+
+    SourceAsset->MarkPackageDirty();
+
+    BuildRuntimeNav();
+#endif
+}
+
+bool UMGDNNavVolumeComponent::BakeGrid(UMGDNNavDataAsset* Target, float InCellSize, float InCellHeight,
+                                       float AgentRadius, float AgentHeight)
+{
+#if WITH_EDITOR
+    if (!Target) return false;
+
     AActor* Owner = GetOwner();
-    if (!Owner) return;
+    if (!Owner) return false;
 
     UWorld* W = GetWorld();
-    if (!W) return;
+    if (!W) return false;
 
     const FTransform T = Owner->GetActorTransform();
 
@@ -77,21 +302,22 @@ void UMGDNNavVolumeComponent::BakeNow()
     const FVector Max = LocalBox.Max;
     const FVector Extent = (Max - Min) * 0.5f;
 
-    float CW = (CellSize   > 1.f) ? CellSize   : 100.f;
-    float CH = (CellHeight > 1.f) ? CellHeight : 100.f;
+    float CW = (InCellSize   > 1.f) ? InCellSize   : 100.f;
+    float CH = (InCellHeight > 1.f) ? InCellHeight : 100.f;
 
     int32 GX = FMath::Max(1, int32((Max.X - Min.X) / CW));
     int32 GY = FMath::Max(1, int32((Max.Y - Min.Y) / CW));
     int32 GZ = FMath::Max(1, int32((Max.Z - Min.Z) / CH));
 
-    SourceAsset->GridX = GX;
-    SourceAsset->GridY = GY;
-    SourceAsset->GridZ = GZ;
+    Target->Layout = CellLayout;
+
+    Target->CellSize   = CW;
+    Target->CellHeight = CH;
 
-    SourceAsset->CellSize   = CW;
-    SourceAsset->CellHeight = CH;
+    Target->AgentRadius = AgentRadius;
+    Target->AgentHeight = AgentHeight;
 
-    SourceAsset->HalfSize = FVector(
+    Target->HalfSize = FVector(
         GX * CW * 0.5f,
         GY * CW * 0.5f,
         GZ * CH * 0.5f
@@ -101,15 +327,15 @@ void UMGDNNavVolumeComponent::BakeNow()
     const float BY = Min.Y + CW * 0.5f;
     const float BZ = Min.Z + CH * 0.5f;
 
-    const int32 Num = GX * GY * GZ;
-    SourceAsset->Nodes.SetNum(Num);
+    // Traced at full volume size, cropped and stored once every cell is known
+    TArray<FMGDNGridNode> Dense;
+    Dense.SetNum(GX * GY * GZ);
 
     for (int32 Z=0; Z<GZ; Z++)
     for (int32 Y=0; Y<GY; Y++)
     for (int32 X=0; X<GX; X++)
     {
-        int32 ID = SourceAsset->Index(X, Y, Z);
-        auto& Node = SourceAsset->Nodes[ID];
+        auto& Node = Dense[X + Y * GX + Z * GX * GY];
 
         FVector Local(
             BX + X*CW,
@@ -124,7 +350,7 @@ void UMGDNNavVolumeComponent::BakeNow()
             W,
             WP + FVector(0,0,50),
             WP - FVector(0,0,50),
-            CellSize * 0.4f,
+            CW * 0.4f,
             ETraceTypeQuery::TraceTypeQuery1,
             false, {},
             EDrawDebugTrace::None,
@@ -133,6 +359,7 @@ void UMGDNNavVolumeComponent::BakeNow()
         );
 
         Node.bWalkable = bHit;
+        Node.bIsRamp = false;
 
         if (Node.bWalkable)
         {
@@ -143,6 +370,9 @@ void UMGDNNavVolumeComponent::BakeNow()
             {
                 Node.bWalkable = false;
             }
+
+            // Sloped floor, may climb into the next layer
+            Node.bIsRamp = Node.bWalkable && N.Z < RampNormalZ;
         }
 
         if (Node.bWalkable)
@@ -150,6 +380,31 @@ void UMGDNNavVolumeComponent::BakeNow()
             Node.Height = Hit.Location.Z;
         }
 
+        // Room above the floor for the layer's agent, only within this cell's column
+        if (Node.bWalkable && AgentHeight > 0.f)
+        {
+            const float R = FMath::Min(AgentRadius, CW * 0.4f);
+            const float Bottom = R + MaxStepHeight;
+
+            FHitResult Overhead;
+            const bool bBlocked = UKismetSystemLibrary::SphereTraceSingle(
+                W,
+                Hit.Location + FVector(0, 0, Bottom),
+                Hit.Location + FVector(0, 0, FMath::Max(AgentHeight - R, Bottom)),
+                R,
+                ETraceTypeQuery::TraceTypeQuery1,
+                false, {},
+                EDrawDebugTrace::None,
+                Overhead,
+                true
+            );
+
+            if (bBlocked)
+            {
+                Node.bWalkable = false;
+            }
+        }
+
         // check if there is navmesh one more time
         if (Node.bWalkable)
         {
@@ -180,17 +435,64 @@ void UMGDNNavVolumeComponent::BakeNow()
         }
     }
 
-    SourceAsset->MarkPackageDirty();
+    // Crop empty borders, CellOffset keeps the grid at its place in the volume
+    FIntVector CropMin(0, 0, 0);
+    FIntVector CropMax(GX - 1, GY - 1, GZ - 1);
+
+    if (bCropToWalkable)
+    {
+        FIntVector WalkMin(GX, GY, GZ);
+        FIntVector WalkMax(-1, -1, -1);
+
+        for (int32 Z=0; Z<GZ; Z++)
+        for (int32 Y=0; Y<GY; Y++)
+        for (int32 X=0; X<GX; X++)
+        {
+            if (!Dense[X + Y * GX + Z * GX * GY].bWalkable)
+                continue;
+
+            WalkMin = FIntVector(FMath::Min(WalkMin.X, X), FMath::Min(WalkMin.Y, Y), FMath::Min(WalkMin.Z, Z));
+            WalkMax = FIntVector(FMath::Max(WalkMax.X, X), FMath::Max(WalkMax.Y, Y), FMath::Max(WalkMax.Z, Z));
+        }
+
+        if (WalkMax.X >= 0)
+        {
+            CropMin = WalkMin;
+            CropMax = WalkMax;
+        }
+    }
+
+    const FIntVector Size = CropMax - CropMin + FIntVector(1, 1, 1);
+
+    TArray<FMGDNGridNode> Cropped;
+    Cropped.SetNum(Size.X * Size.Y * Size.Z);
+
+    for (int32 Z=0; Z<Size.Z; Z++)
+    for (int32 Y=0; Y<Size.Y; Y++)
+    for (int32 X=0; X<Size.X; X++)
+    {
+        Cropped[X + Y * Size.X + Z * Size.X * Size.Y] =
+            Dense[(CropMin.X + X) + (CropMin.Y + Y) * GX + (CropMin.Z + Z) * GX * GY];
+    }
 
-    if (!RuntimeNav)
-        RuntimeNav = NewObject<UMGDNRuntimeNavMesh>(this);
+    Target->GridX = Size.X;
+    Target->GridY = Size.Y;
+    Target->GridZ = Size.Z;
+    Target->CellOffset = CropMin;
 
-    RuntimeNav->BuildFromAsset(SourceAsset);
+    if (bSparseStorage)
+        Target->SetSpansFromDense(Cropped);
+    else
+        Target->SetNodesFromDense(Cropped);
 
     UE_LOG(LogTemp, Warning,
-        TEXT("[MGDN] BakeNow OK  Grid=%dx%dx%d  Cell=%.1f Height=%.1f"),
-        GX, GY, GZ, CW, CH);
+        TEXT("[MGDN] BakeNow OK  Grid=%dx%dx%d of %dx%dx%d Offset=(%d,%d,%d)  Cell=%.1f Height=%.1f  Agent=%.0fx%.0f  Walkable=%d Sparse=%d"),
+        Size.X, Size.Y, Size.Z, GX, GY, GZ, CropMin.X, CropMin.Y, CropMin.Z, CW, CH, AgentRadius, AgentHeight,
+        Target->CountWalkable(), bSparseStorage ? 1 : 0);
 
+    return true;
+#else
+    return false;
 #endif
 }
 
@@ -199,7 +501,7 @@ void UMGDNNavVolumeComponent::VisualizeGrid()
 {
 #if WITH_EDITOR
 	if (!SourceAsset) return;
-	if (SourceAsset->Nodes.Num() == 0) return;
+	if (SourceAsset->Nodes.Num() == 0 && !SourceAsset->IsSparse()) return;
 
 	AActor* Owner = GetOwner();
 	if (!Owner) return;
@@ -220,9 +522,11 @@ void UMGDNNavVolumeComponent::VisualizeGrid()
 	const float CW = SourceAsset->CellSize;
 	const float CH = SourceAsset->CellHeight;
 
-	const float BX = Min.X + CW * 0.5f;
-	const float BY = Min.Y + CW * 0.5f;
-	const float BZ = Min.Z + CH * 0.5f;
+	const FIntVector& Offset = SourceAsset->CellOffset;
+
+	const float BX = Min.X + CW * (Offset.X + 0.5f);
+	const float BY = Min.Y + CW * (Offset.Y + 0.5f);
+	const float BZ = Min.Z + CH * (Offset.Z + 0.5f);
 
 	int32 Count = 0;
 
@@ -230,8 +534,8 @@ void UMGDNNavVolumeComponent::VisualizeGrid()
 		for (int32 Y=0; Y<GY; Y++)
 			for (int32 X=0; X<GX; X++)
 			{
-				int32 ID = SourceAsset->Index(X,Y,Z);
-				if (!SourceAsset->Nodes[ID].bWalkable)
+				const FMGDNGridNode* Node = SourceAsset->FindNode(X, Y, Z);
+				if (!Node || !Node->bWalkable)
 					continue;
 
 				FVector Local(
@@ -250,3 +554,52 @@ void UMGDNNavVolumeComponent::VisualizeGrid()
 		TEXT("[MGDN] VisualizeGrid drew %d walkable nodes"), Count);
 #endif
 }
+
+void UMGDNNavVolumeComponent::BenchmarkPaths()
+{
+#if WITH_EDITOR
+	if (!BuildRuntimeNav())
+		return;
+
+	TArray<int32> WalkableCells;
+	for (int32 i = 0; i < RuntimeNav->Walkable.Num(); ++i)
+	{
+		if (RuntimeNav->Walkable[i])
+			WalkableCells.Add(i);
+	}
+
+	if (WalkableCells.Num() < 2)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[MGDN] Benchmark needs at least two walkable cells"));
+		return;
+	}
+
+	// Fixed seed, the same pairs are queried on every run
+	FRandomStream Stream(1337);
+
+	TArray<int32> Path;
+	int32 Found = 0;
+	int64 Expansions = 0;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	for (int32 Q = 0; Q < BenchmarkQueryCount; ++Q)
+	{
+		const int32 A = WalkableCells[Stream.RandHelper(WalkableCells.Num())];
+		const int32 B = WalkableCells[Stream.RandHelper(WalkableCells.Num())];
+
+		FMGDNSearchStats Stats;
+		if (RuntimeNav->FindIndexPath(A, B, Path, FMGDNPathQuery(), &Stats))
+			Found++;
+
+		Expansions += Stats.Expansions;
+	}
+
+	const double Elapsed = FMath::Max(FPlatformTime::Seconds() - StartTime, 1e-9);
+
+	UE_LOG(LogTemp, Warning,
+		TEXT("[MGDN] Benchmark %d queries Found=%d Time=%.2fms Avg=%.3fms Expansions=%lld (%.0f/s)"),
+		BenchmarkQueryCount, Found, Elapsed * 1000.0, Elapsed * 1000.0 / BenchmarkQueryCount,
+		Expansions, double(Expansions) / Elapsed);
+#endif
+}
@@ -0,0 +1,226 @@
+﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
+#include "MGDNRuntimeNavMesh.h"
+#include "MGDNSearchState.h"
+#include "MGDNSearchPolicies.h"
+
+// Nearest of several goals.
+// One A* search runs towards all goals at once, with the smallest heuristic over the goals as its
+// heuristic. That is a lower bound on the distance to the nearest goal and stays consistent, so the
+// first goal taken from the open list is the one with the shortest path, found in one search
+// instead of one per candidate. Past a handful of goals the heuristic costs more than it saves and
+// the search runs as Dijkstra instead, which settles goals in the same order.
+// Moves and their costs follow the query like the A* kernels do. Octile and landmark bounds only hold
+// for octile steps, unit steps always run as Dijkstra.
+
+namespace
+{
+	// Goals above this run without a heuristic
+	constexpr int32 MaxHeuristicGoals = 16;
+
+	struct FMGDNNearestGoal
+	{
+		FIntVector XYZ;
+		const float* LandmarkCosts = nullptr;
+	};
+}
+
+bool UMGDNRuntimeNavMesh::FindNearestGoalPath(
+	int32 StartIndex,
+	TConstArrayView<int32> GoalIndices,
+	TArray<int32>& OutIndices,
+	int32& OutGoal,
+	const FMGDNPathQuery& Query,
+	FMGDNSearchStats* OutStats) const
+{
+	OutIndices.Reset();
+	OutGoal = INDEX_NONE;
+
+	if (OutStats)
+	{
+		*OutStats = FMGDNSearchStats();
+	}
+
+	if (!Walkable.IsValidIndex(StartIndex) || !IsOpen(StartIndex))
+		return false;
+
+	// Goal cell to its position in GoalIndices, the first entry wins for duplicates
+	TMap<int32, int32> GoalSlots;
+	TArray<FMGDNNearestGoal> Goals;
+
+	for (int32 i = 0; i < GoalIndices.Num(); ++i)
+	{
+		const int32 Goal = GoalIndices[i];
+
+		if (!Walkable.IsValidIndex(Goal) || !IsOpen(Goal) || !AreConnected(StartIndex, Goal) || GoalSlots.Contains(Goal))
+			continue;
+
+		if (Goal == StartIndex)
+		{
+			OutIndices.Add(StartIndex);
+			OutGoal = i;
+			return true;
+		}
+
+		GoalSlots.Add(Goal, i);
+
+		FMGDNNearestGoal& Entry = Goals.AddDefaulted_GetRef();
+		ToXYZ(Goal, Entry.XYZ.X, Entry.XYZ.Y, Entry.XYZ.Z);
+		Entry.LandmarkCosts = GetLandmarkCosts(Goal);
+	}
+
+	if (Goals.Num() == 0)
+		return false;
+
+	const uint32 MoveBits = MGDNSearchPolicies::MoveBitsOf(Query.MoveSet);
+	const bool bUnitSteps = Query.StepCost == EMGDNStepCost::Unit;
+	const bool bCellCosts = Query.bUseCellCosts && HasCellCosts();
+
+	const bool bHeuristic = Goals.Num() <= MaxHeuristicGoals && !bUnitSteps;
+	const float HeuristicWeight = FMath::Max(Query.HeuristicWeight, 1.f);
+	const float MinClearance = RequiredClearance(Query.AgentRadius);
+
+	auto Heuristic = [this, &Goals, bHeuristic](int32 Index, int32 X, int32 Y, int32 Z)
+	{
+		if (!bHeuristic)
+			return 0.f;
+
+		float H = FLT_MAX;
+		for (const FMGDNNearestGoal& Goal : Goals)
+		{
+			H = FMath::Min(H, PathHeuristic(Index, X, Y, Z, Goal.XYZ, Goal.LandmarkCosts));
+		}
+		return H;
+	};
+
+	FMGDNScopedSearchState Search;
+	FMGDNSearchState& S = *Search;
+	S.Begin(NumCellIndices());
+
+	FMGDNSearchStats Stats;
+
+	{
+		int32 SX, SY, SZ;
+		ToXYZ(StartIndex, SX, SY, SZ);
+
+		S.Visit(StartIndex).G = 0.f;
+		const float H = Heuristic(StartIndex, SX, SY, SZ);
+		S.Push(StartIndex, HeuristicWeight * H, H);
+		Stats.Pushes++;
+	}
+
+	int32 Found = INDEX_NONE;
+
+	while (!S.IsOpenEmpty())
+	{
+		const int32 Current = S.Pop();
+		Stats.Expansions++;
+
+		if (const int32* Slot = GoalSlots.Find(Current))
+		{
+			Found = Current;
+			OutGoal = *Slot;
+			break;
+		}
+
+		const float CurrentG = S.Records[Current].G;
+
+		int32 CX, CY, CZ;
+		ToXYZ(Current, CX, CY, CZ);
+
+		uint32 Moves = GetMoveMask(Current) & MoveBits;
+		while (Moves)
+		{
+			const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+			Moves &= Moves - 1;
+
+			const int32 NIndex = StepIndex(Current, CX, CY, CZ, Bit);
+
+			// Goals are exempt like the end cell of a single goal search
+			if (!HasClearance(NIndex, MinClearance) && !GoalSlots.Contains(NIndex))
+				continue;
+
+			FMGDNCellRecord& N = S.Visit(NIndex);
+
+			if (N.HeapSlot == FMGDNSearchState::ClosedSlot)
+				continue;
+
+			float Step = bUnitSteps ? 1.f : MoveCost(Bit);
+			if (bCellCosts)
+			{
+				Step *= CellCosts[Walkable.Rank(NIndex)];
+			}
+
+			const float NewG = CurrentG + Step;
+
+			if (NewG < N.G)
+			{
+				N.G      = NewG;
+				N.Parent = Current;
+
+				const FIntVector D = FMGDNWalkableBits::BitDelta(Bit);
+				const float H = Heuristic(NIndex, CX + D.X, CY + D.Y, CZ + D.Z);
+				S.Push(NIndex, NewG + HeuristicWeight * H, H);
+				Stats.Pushes++;
+			}
+		}
+	}
+
+	if (Found != INDEX_NONE)
+	{
+		S.BuildPath(Found, OutIndices);
+	}
+
+	if (OutStats)
+	{
+		*OutStats = Stats;
+	}
+
+	return Found != INDEX_NONE;
+}
+
+bool UMGDNRuntimeNavMesh::FindNearestPath(
+	const FTransform& PlatformTransform,
+	const FVector& StartWorld,
+	TConstArrayView<FVector> GoalsWorld,
+	TArray<FVector>& OutWorldPath,
+	int32& OutGoal,
+	const FMGDNPathQuery& Query
+) const
+{
+	OutWorldPath.Reset();
+	OutGoal = INDEX_NONE;
+
+	// Each goal gets the fallbacks FindPath gives its end point, goals that resolve to nothing drop out.
+	// The start cell is the one resolved for the first goal.
+	int32 StartIndex = INDEX_NONE;
+	TArray<int32> GoalIndices;
+	GoalIndices.Init(INDEX_NONE, GoalsWorld.Num());
+
+	for (int32 i = 0; i < GoalsWorld.Num(); ++i)
+	{
+		int32 GoalStart;
+		if (ResolvePathCells(PlatformTransform, StartWorld, GoalsWorld[i], GoalStart, GoalIndices[i]) && StartIndex == INDEX_NONE)
+		{
+			StartIndex = GoalStart;
+		}
+	}
+
+	if (StartIndex == INDEX_NONE)
+		return false;
+
+	TArray<int32> IndexPath;
+	if (!FindNearestGoalPath(StartIndex, GoalIndices, IndexPath, OutGoal, Query))
+	{
+		UE_LOG(LogTemp, Verbose,
+			TEXT("[MGDN] FindNearestPath: None of %d goals reachable from %d"), GoalsWorld.Num(), StartIndex);
+		return false;
+	}
+
+	if (Query.bSmoothPath)
+	{
+		SmoothIndexPath(IndexPath, Query);
+	}
+
+	IndexPathToWorld(PlatformTransform, IndexPath, OutWorldPath);
+	return OutWorldPath.Num() > 0;
+}
@@ -1,7 +1,8 @@
 ﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
 #include "MGDNRuntimeNavMesh.h"
 #include "MGDNNavDataAsset.h"
-#include "Algo/Reverse.h"
+#include "MGDNSearchPolicies.h"
+#include "MGDNSearchState.h"
 
 bool UMGDNRuntimeNavMesh::BuildFromAsset(const UMGDNNavDataAsset* Asset)
 {
@@ -18,224 +19,1448 @@ bool UMGDNRuntimeNavMesh::BuildFromAsset(const UMGDNNavDataAsset* Asset)
 		return false;
 	}
 
-	const int32 Num = Asset->GridX * Asset->GridY * Asset->GridZ;
-	if (Asset->Nodes.Num() != Num)
+	if (Asset->IsSparse())
+	{
+		if (Asset->ColumnSpans.Num() != Asset->GridX * Asset->GridY + 1)
+		{
+			UE_LOG(LogTemp, Error,
+				TEXT("[MGDN] BuildFromAsset: Column count mismatch Columns=%d Expected=%d"),
+				Asset->ColumnSpans.Num() - 1, Asset->GridX * Asset->GridY);
+			return false;
+		}
+	}
+	else if (Asset->Nodes.Num() != Asset->NumIndices())
 	{
 		UE_LOG(LogTemp, Error,
 			TEXT("[MGDN] BuildFromAsset: Node count mismatch Nodes=%d Expected=%d"),
-			Asset->Nodes.Num(), Num);
+			Asset->Nodes.Num(), Asset->NumIndices());
 		return false;
 	}
 
-	GridX      = Asset->GridX;
-	GridY      = Asset->GridY;
-	GridZ      = Asset->GridZ;
-	CellSize   = Asset->CellSize;
-	CellHeight = Asset->CellHeight;
-	HalfSize   = Asset->HalfSize;
+	GridX      = Asset->GridX;
+	GridY      = Asset->GridY;
+	GridZ      = Asset->GridZ;
+	CellSize   = Asset->CellSize;
+	CellHeight = Asset->CellHeight;
+	HalfSize   = Asset->HalfSize;
+	CellOffset = Asset->CellOffset;
+	Layout     = Asset->Layout;
+
+	// Cells of searches started before now index the old grid
+	GridVersion++;
+
+	const int32 Num = NumCellIndices();
+
+	InitCellBits(Walkable);
+
+	if (Asset->IsSparse())
+	{
+		for (int32 Column = 0; Column < GridX * GridY; ++Column)
+		{
+			for (int32 i = Asset->ColumnSpans[Column]; i < Asset->ColumnSpans[Column + 1]; ++i)
+			{
+				const FMGDNColumnSpan& Span = Asset->Spans[i];
+
+				for (int32 k = 0; k < Span.NumCells; ++k)
+				{
+					if (Asset->SpanNodes[Span.FirstNode + k].bWalkable)
+						Walkable.Set(ToIndex(Column % GridX, Column / GridX, Span.MinZ + k), true);
+				}
+			}
+		}
+	}
+	else
+	{
+		for (int32 i = 0; i < Num; ++i)
+		{
+			Walkable.Set(i, Asset->Nodes[i].bWalkable);
+		}
+	}
+
+	for (int32 DZ = -1; DZ <= 1; ++DZ)
+	for (int32 DY = -1; DY <= 1; ++DY)
+	for (int32 DX = -1; DX <= 1; ++DX)
+	{
+		NeighborOffsets[FMGDNWalkableBits::BitOf(DX, DY, DZ)] = DX + DY * GridX + DZ * (GridX * GridY);
+	}
+
+	const int32 BricksX = MGDNCellLayout::BricksAlong(GridX);
+	const int32 BricksY = MGDNCellLayout::BricksAlong(GridY);
+	BrickStrides = FIntVector(64, BricksX * 64, BricksX * BricksY * 64);
+
+	BuildConnectivity(Asset);
+	BuildComponents();
+	BuildNearestWalkable();
+	BuildClearance();
+	BuildJumpStops();
+	BuildLandmarks();
+
+	JumpDistances.Reset();
+	ClusterGraph.Reset();
+
+	BlockedCells.Reset();
+	NumBlockedCells = 0;
+	BakedConnectivity.Reset();
+	BakedComponents.Reset();
+	bComponentsStale = false;
+	CellCosts.Reset();
+
+	MarkNavDataChanged();
+
+	// Incremental searches of the old grid cannot be repaired from a change log
+	CellChanges.Reset();
+	CellChangesFrom = NavVersion;
+
+	switch (ResolveSearchMode(EMGDNSearchMode::Default))
+	{
+	case EMGDNSearchMode::JumpPoint:
+		BuildJumpTable();
+		break;
+
+	case EMGDNSearchMode::Hierarchical:
+		BuildClusterGraph();
+		break;
+
+	default:
+		break;
+	}
+
+	// Obstacles outlive rebuilds, stamp them onto the new grid
+	ObstacleRefs.Reset();
+	for (TPair<int32, FMGDNObstacle>& Pair : Obstacles)
+	{
+		TArray<int32> Cells;
+		GatherObstacleCells(Pair.Value.LocalTransform, Pair.Value.Extent, Cells);
+		RestampObstacleCells(TArray<int32>(), Cells);
+		Pair.Value.Cells = MoveTemp(Cells);
+	}
+
+	UE_LOG(LogTemp, Log,
+		TEXT("[MGDN] RuntimeNav BuildFromAsset OK Grid=%dx%dx%d Cell=%.1f Height=%.1f Walkable=%d/%d Components=%d (%d bytes)"),
+		GridX, GridY, GridZ, CellSize, CellHeight, Connectivity.Num(), Num, NumComponents,
+		int32(Walkable.GetAllocatedSize() + Connectivity.GetAllocatedSize() + Components.GetAllocatedSize() +
+		      NearestWalkable.GetAllocatedSize() + Clearance.GetAllocatedSize() + LandmarkCosts.GetAllocatedSize()));
+
+	return true;
+}
+
+void UMGDNRuntimeNavMesh::BuildConnectivity(const UMGDNNavDataAsset* Asset)
+{
+	Walkable.BuildRanks();
+
+	Connectivity.Reset();
+	Connectivity.Reserve(Walkable.CountWalkable());
+
+	int32 VerticalMoves = 0;
+
+	// Index order, so each walkable cell lands at its rank
+	const int32 Num = NumCellIndices();
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		if (!Walkable[Index])
+			continue;
+
+		int32 X, Y, Z;
+		ToXYZ(Index, X, Y, Z);
+
+		const FMGDNGridNode& Node = *Asset->FindNode(X, Y, Z);
+
+		uint32 Candidates = GatherWalkableNeighbors(Index, X, Y, Z) & ~FMGDNWalkableBits::CenterBit;
+		uint32 Moves = 0;
+
+		while (Candidates)
+		{
+			const int32 Bit = int32(FMath::CountTrailingZeros(Candidates));
+			Candidates &= Candidates - 1;
+
+			const FIntVector D = FMGDNWalkableBits::BitDelta(Bit);
+			const FMGDNGridNode& Other = *Asset->FindNode(X + D.X, Y + D.Y, Z + D.Z);
+			const bool bRamp = Node.bIsRamp || Other.bIsRamp;
+
+			// Decks only connect through ramps and stairs
+			if (D.Z != 0 && !bRamp)
+				continue;
+
+			// A ramp may climb up to its horizontal run on top of a normal step
+			const float Run = bRamp ? CellSize * FMath::Sqrt(float(D.X * D.X + D.Y * D.Y)) : 0.f;
+
+			if (FMath::Abs(Node.Height - Other.Height) > MaxStepHeight + Run)
+				continue;
+
+			Moves |= 1u << Bit;
+		}
+
+		if (Moves & FMGDNWalkableBits::VerticalBits)
+			VerticalMoves++;
+
+		Connectivity.Add(Moves);
+	}
+
+	if (GridZ > 1 && VerticalMoves == 0)
+	{
+		UE_LOG(LogTemp, Warning,
+			TEXT("[MGDN] BuildConnectivity: No ramp links between layers, rebake the asset if decks should connect"));
+	}
+}
+
+void UMGDNRuntimeNavMesh::BuildComponents() const
+{
+	const int32 NumWalkable = Connectivity.Num();
+
+	// Union-find over walkable ranks, moves are symmetric so each set is one reachable region
+	TArray<int32> Parent;
+	Parent.SetNumUninitialized(NumWalkable);
+	for (int32 i = 0; i < NumWalkable; ++i)
+	{
+		Parent[i] = i;
+	}
+
+	auto Find = [&Parent](int32 R)
+	{
+		while (Parent[R] != R)
+		{
+			Parent[R] = Parent[Parent[R]];
+			R = Parent[R];
+		}
+		return R;
+	};
+
+	// Bits above the centre lead to later cells, their reverse moves cover the rest
+	constexpr uint32 ForwardBits = ~((FMGDNWalkableBits::CenterBit << 1) - 1);
+
+	const int32 Num = NumCellIndices();
+	int32 Rank = 0;
+
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		if (!Walkable[Index])
+			continue;
+
+		int32 X, Y, Z;
+		ToXYZ(Index, X, Y, Z);
+
+		uint32 Moves = Connectivity[Rank] & ForwardBits;
+		while (Moves)
+		{
+			const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+			Moves &= Moves - 1;
+
+			const int32 A = Find(Rank);
+			const int32 B = Find(Walkable.Rank(StepIndex(Index, X, Y, Z, Bit)));
+			if (A != B)
+			{
+				Parent[FMath::Max(A, B)] = FMath::Min(A, B);
+			}
+		}
+
+		Rank++;
+	}
+
+	// Roots point at themselves and come before their members, so one pass numbers them in order
+	Components.SetNumUninitialized(NumWalkable);
+	NumComponents = 0;
+
+	for (int32 i = 0; i < NumWalkable; ++i)
+	{
+		const int32 Root = Find(i);
+		Components[i] = Root == i ? NumComponents++ : Components[Root];
+	}
+}
+
+void UMGDNRuntimeNavMesh::RefreshComponents() const
+{
+	// Several workers may find the labels stale at once, one relabels while the others wait for it
+	FScopeLock Lock(&ComponentsLock);
+
+	if (!bComponentsStale.load(std::memory_order_relaxed))
+		return;
+
+	BuildComponents();
+	bComponentsStale.store(false, std::memory_order_release);
+
+	UE_LOG(LogTemp, Verbose, TEXT("[MGDN] RefreshComponents: %d components"), NumComponents);
+}
+
+namespace
+{
+	// Scratch of one TransformLine call, reused across lines
+	struct FMGDNTransformScratch
+	{
+		TArray<float> Dist;
+		TArray<int32> Feature;
+		TArray<int32> Roots;
+		TArray<double> Bounds;
+	};
+
+	// One axis of the separable squared distance transform (Felzenszwalb and Huttenlocher).
+	// Every sample with a finite distance roots a parabola Dist + Scale2 * (Q - Root)^2, each
+	// sample then takes the distance and feature cell of the lowest parabola above it.
+	void TransformLine(float* Dist, int32* Feature, int32 Count, int32 Stride, double Scale2, FMGDNTransformScratch& Scratch)
+	{
+		Scratch.Dist.SetNumUninitialized(Count, EAllowShrinking::No);
+		Scratch.Feature.SetNumUninitialized(Count, EAllowShrinking::No);
+		Scratch.Roots.SetNumUninitialized(Count, EAllowShrinking::No);
+		Scratch.Bounds.SetNumUninitialized(Count + 1, EAllowShrinking::No);
+
+		for (int32 Q = 0; Q < Count; ++Q)
+		{
+			Scratch.Dist[Q]    = Dist[Q * Stride];
+			Scratch.Feature[Q] = Feature[Q * Stride];
+		}
+
+		// Where the parabolas of roots P and Q cross
+		auto Intersect = [&Scratch, Scale2](int32 P, int32 Q)
+		{
+			return ((Scratch.Dist[Q] + Scale2 * Q * Q) - (Scratch.Dist[P] + Scale2 * P * P)) / (2.0 * Scale2 * (Q - P));
+		};
+
+		int32 K = -1;
+
+		for (int32 Q = 0; Q < Count; ++Q)
+		{
+			if (Scratch.Dist[Q] == FLT_MAX)
+				continue;
+
+			if (K < 0)
+			{
+				K = 0;
+				Scratch.Roots[0]  = Q;
+				Scratch.Bounds[0] = -DBL_MAX;
+				Scratch.Bounds[1] = DBL_MAX;
+				continue;
+			}
+
+			double S = Intersect(Scratch.Roots[K], Q);
+			while (S <= Scratch.Bounds[K])
+			{
+				K--;
+				S = Intersect(Scratch.Roots[K], Q);
+			}
+
+			K++;
+			Scratch.Roots[K]      = Q;
+			Scratch.Bounds[K]     = S;
+			Scratch.Bounds[K + 1] = DBL_MAX;
+		}
+
+		// Nothing on this line, it stays infinite for the next axis
+		if (K < 0)
+			return;
+
+		K = 0;
+		for (int32 Q = 0; Q < Count; ++Q)
+		{
+			while (Scratch.Bounds[K + 1] < Q)
+				K++;
+
+			const int32 Root = Scratch.Roots[K];
+			Dist[Q * Stride]    = float(Scratch.Dist[Root] + Scale2 * (Q - Root) * (Q - Root));
+			Feature[Q * Stride] = Scratch.Feature[Root];
+		}
+	}
+}
+
+void UMGDNRuntimeNavMesh::BuildNearestWalkable()
+{
+	const int32 XYCount = GridX * GridY;
+	const int32 Count   = XYCount * GridZ;
+
+	// Linear order while transforming, the layout index is only the stored feature
+	TArray<float> Dist;
+	TArray<int32> Feature;
+	Dist.SetNumUninitialized(Count);
+	Feature.SetNumUninitialized(Count);
+
+	for (int32 Z = 0; Z < GridZ; Z++)
+	for (int32 Y = 0; Y < GridY; Y++)
+	for (int32 X = 0; X < GridX; X++)
+	{
+		const int32 Linear = X + Y * GridX + Z * XYCount;
+		const int32 Index  = ToIndex(X, Y, Z);
+		const bool bWalk   = Walkable[Index];
+
+		Dist[Linear]    = bWalk ? 0.f : FLT_MAX;
+		Feature[Linear] = bWalk ? Index : INDEX_NONE;
+	}
+
+	// Distances in horizontal cells, a layer step counts CellHeight / CellSize of them
+	const double ZScale = CellSize > 0.f ? double(CellHeight) / CellSize : 1.0;
+
+	FMGDNTransformScratch Scratch;
+
+	for (int32 Z = 0; Z < GridZ; Z++)
+	for (int32 Y = 0; Y < GridY; Y++)
+	{
+		const int32 Row = Y * GridX + Z * XYCount;
+		TransformLine(&Dist[Row], &Feature[Row], GridX, 1, 1.0, Scratch);
+	}
+
+	for (int32 Z = 0; Z < GridZ; Z++)
+	for (int32 X = 0; X < GridX; X++)
+	{
+		const int32 Column = X + Z * XYCount;
+		TransformLine(&Dist[Column], &Feature[Column], GridY, GridX, 1.0, Scratch);
+	}
+
+	for (int32 Column = 0; Column < XYCount; ++Column)
+	{
+		TransformLine(&Dist[Column], &Feature[Column], GridZ, XYCount, ZScale * ZScale, Scratch);
+	}
+
+	NearestWalkable.Init(INDEX_NONE, NumCellIndices());
+
+	for (int32 Z = 0; Z < GridZ; Z++)
+	for (int32 Y = 0; Y < GridY; Y++)
+	for (int32 X = 0; X < GridX; X++)
+	{
+		NearestWalkable[ToIndex(X, Y, Z)] = Feature[X + Y * GridX + Z * XYCount];
+	}
+}
+
+void UMGDNRuntimeNavMesh::BuildClearance()
+{
+	// One layer with a ring of blocked cells around it, so the grid edge counts as a wall
+	const int32 PadX = GridX + 2;
+	const int32 PadY = GridY + 2;
+
+	TArray<float> Dist;
+	TArray<int32> Feature;
+	Dist.SetNumUninitialized(PadX * PadY);
+	Feature.SetNumZeroed(PadX * PadY);
+
+	FMGDNTransformScratch Scratch;
+
+	Clearance.SetNumUninitialized(Connectivity.Num());
+
+	for (int32 Z = 0; Z < GridZ; Z++)
+	{
+		for (int32 Y = 0; Y < PadY; Y++)
+		for (int32 X = 0; X < PadX; X++)
+		{
+			Dist[X + Y * PadX] = IsWalkable(X - 1, Y - 1, Z) ? FLT_MAX : 0.f;
+		}
+
+		for (int32 Y = 0; Y < PadY; Y++)
+		{
+			TransformLine(&Dist[Y * PadX], &Feature[Y * PadX], PadX, 1, 1.0, Scratch);
+		}
+
+		for (int32 X = 0; X < PadX; X++)
+		{
+			TransformLine(&Dist[X], &Feature[X], PadY, PadX, 1.0, Scratch);
+		}
+
+		// Centre to centre distance to the nearest blocked cell, less the half cell up to its edge
+		for (int32 Y = 0; Y < GridY; Y++)
+		for (int32 X = 0; X < GridX; X++)
+		{
+			const int32 Index = ToIndex(X, Y, Z);
+			if (!Walkable[Index])
+				continue;
+
+			Clearance[Walkable.Rank(Index)] = (FMath::Sqrt(Dist[(X + 1) + (Y + 1) * PadX]) - 0.5f) * CellSize;
+		}
+	}
+}
+
+int32 UMGDNRuntimeNavMesh::FindNearestWalkable(int32 SX, int32 SY, int32 SZ, int32 SearchRadius, int32 PreferredComponent) const
+{
+	if (!IsValid(SX, SY, SZ))
+		return INDEX_NONE;
+
+	const int32 Nearest = NearestWalkable[ToIndex(SX, SY, SZ)];
+
+	if (Nearest == INDEX_NONE ||
+		((PreferredComponent == INDEX_NONE || GetComponent(Nearest) == PreferredComponent) && !IsCellBlocked(Nearest)))
+		return Nearest;
+
+	// Nearest cell sits in another region or is blocked, take the closest open one of the preferred region around the point instead
+	const float ZScale = CellHeight / CellSize;
+
+	int32 Best = INDEX_NONE;
+	float BestDist = FLT_MAX;
+
+	for (int32 DZ = -SearchRadius; DZ <= SearchRadius; DZ++)
+	for (int32 DY = -SearchRadius; DY <= SearchRadius; DY++)
+	for (int32 DX = -SearchRadius; DX <= SearchRadius; DX++)
+	{
+		const int32 NX = SX + DX;
+		const int32 NY = SY + DY;
+		const int32 NZ = SZ + DZ;
+
+		if (!IsValid(NX, NY, NZ))
+			continue;
+
+		const int32 NI = ToIndex(NX, NY, NZ);
+		if (!IsOpen(NI) || (PreferredComponent != INDEX_NONE && GetComponent(NI) != PreferredComponent))
+			continue;
+
+		const float Dist = float(DX * DX + DY * DY) + FMath::Square(DZ * ZScale);
+		if (Dist < BestDist)
+		{
+			BestDist = Dist;
+			Best = NI;
+		}
+	}
+
+	if (Best != INDEX_NONE)
+		return Best;
+
+	return IsCellBlocked(Nearest) ? INDEX_NONE : Nearest;
+}
+
+void UMGDNRuntimeNavMesh::InitCellBits(FMGDNWalkableBits& Bits) const
+{
+	if (Layout == EMGDNCellLayout::Brick)
+	{
+		// One 64-bit word per brick, neighbour masks are gathered cell by cell
+		Bits.Init(
+			MGDNCellLayout::BricksAlong(GridX) * 4,
+			MGDNCellLayout::BricksAlong(GridY) * 4,
+			MGDNCellLayout::BricksAlong(GridZ) * 4);
+		return;
+	}
+
+	Bits.Init(GridX, GridY, GridZ);
+}
+
+uint32 UMGDNRuntimeNavMesh::GatherWalkableNeighbors(int32 Index, int32 X, int32 Y, int32 Z) const
+{
+	if (Layout == EMGDNCellLayout::Linear)
+		return Walkable.NeighborMask(Index, X, Y);
+
+	uint32 Mask = 0;
+
+	for (int32 DZ = -1; DZ <= 1; DZ++)
+	for (int32 DY = -1; DY <= 1; DY++)
+	for (int32 DX = -1; DX <= 1; DX++)
+	{
+		if (IsWalkable(X + DX, Y + DY, Z + DZ))
+			Mask |= 1u << FMGDNWalkableBits::BitOf(DX, DY, DZ);
+	}
+
+	return Mask;
+}
+
+void UMGDNRuntimeNavMesh::AddNeighbors26(int32 Index, TArray<int32>& Out, const FMGDNGridBounds* Bounds) const
+{
+	Out.Reset();
+
+	uint32 Moves = GetMoveMask(Index);
+
+	// Linear steps are plain offsets, coordinates are only needed for clipping or other layouts
+	int32 X = 0, Y = 0, Z = 0;
+	if (Bounds || Layout != EMGDNCellLayout::Linear)
+	{
+		ToXYZ(Index, X, Y, Z);
+	}
+
+	if (Bounds)
+	{
+		Moves = ClipMoves(Moves, X, Y, Z, *Bounds);
+	}
+
+	while (Moves)
+	{
+		const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+		Moves &= Moves - 1;
+
+		Out.Add(StepIndex(Index, X, Y, Z, Bit));
+	}
+}
+
+EMGDNSearchMode UMGDNRuntimeNavMesh::ResolveSearchMode(EMGDNSearchMode Requested) const
+{
+	if (Requested == EMGDNSearchMode::Default)
+		Requested = DefaultSearchMode;
+
+	return Requested == EMGDNSearchMode::Default ? EMGDNSearchMode::AStar : Requested;
+}
+
+bool UMGDNRuntimeNavMesh::FindIndexPath(
+	int32 StartIndex,
+	int32 EndIndex,
+	TArray<int32>& OutIndices,
+	const FMGDNPathQuery& Query,
+	FMGDNSearchStats* OutStats) const
+{
+	OutIndices.Reset();
+
+	if (!Walkable.IsValidIndex(StartIndex) || !Walkable.IsValidIndex(EndIndex))
+		return false;
+
+	if (!IsOpen(StartIndex) || !IsOpen(EndIndex))
+		return false;
+
+	// Different regions, no search would ever reach End
+	if (!AreConnected(StartIndex, EndIndex))
+	{
+		if (OutStats)
+		{
+			*OutStats = FMGDNSearchStats();
+		}
+		return false;
+	}
+
+	const float MinClearance = RequiredClearance(Query.AgentRadius);
+	EMGDNSearchMode Mode = ResolveSearchMode(Query.SearchMode);
+
+	// Jump tables and cluster costs are built for the bare baked grid, wide agents and blocked cells need every cell checked
+	if ((MinClearance > 0.f || NumBlockedCells > 0) &&
+		(Mode == EMGDNSearchMode::JumpPoint || Mode == EMGDNSearchMode::Hierarchical))
+	{
+		Mode = EMGDNSearchMode::AStar;
+	}
+
+	// The other modes only know every move at its length
+	const bool bCellCosts = Query.bUseCellCosts && HasCellCosts();
+	if (!HasDefaultMoves(Query))
+	{
+		Mode = EMGDNSearchMode::AStar;
+	}
+
+	switch (Mode)
+	{
+	case EMGDNSearchMode::JumpPoint:
+		return JumpPointSearch(StartIndex, EndIndex, OutIndices, OutStats, Query.HeuristicWeight);
+
+	case EMGDNSearchMode::Hierarchical:
+		return HierarchicalSearch(StartIndex, EndIndex, OutIndices, OutStats);
+
+	case EMGDNSearchMode::Bidirectional:
+		return BidirectionalSearch(StartIndex, EndIndex, OutIndices, OutStats, MinClearance);
+
+	default:
+		return AStar(StartIndex, EndIndex, OutIndices, OutStats, nullptr, Query.HeuristicWeight, MinClearance,
+		             SelectExpandAStar(Query.MoveSet, Query.StepCost, bCellCosts, MinClearance > 0.f));
+	}
+}
+
+bool UMGDNRuntimeNavMesh::HasDefaultMoves(const FMGDNPathQuery& Query) const
+{
+	return Query.MoveSet == EMGDNMoveSet::Corners26 && Query.StepCost == EMGDNStepCost::Octile &&
+		!(Query.bUseCellCosts && HasCellCosts());
+}
+
+bool UMGDNRuntimeNavMesh::AStar(
+	int32 Start,
+	int32 End,
+	TArray<int32>& OutIndices,
+	FMGDNSearchStats* OutStats,
+	const FMGDNGridBounds* Bounds,
+	float HeuristicWeight,
+	float MinClearance,
+	FExpandAStarFn Expand) const
+{
+	OutIndices.Reset();
+
+	if (Start == End)
+	{
+		OutIndices.Add(Start);
+		return true;
+	}
+
+	if (NumCellIndices() <= 0)
+		return false;
+
+	// Records and heap come from the thread's pool, nothing is cleared or allocated per query
+	FMGDNScopedSearchState Search;
+	FMGDNSearchState& S = *Search;
+
+	FMGDNSearchStats Stats;
+	BeginAStar(S, Start, End, HeuristicWeight, Stats);
+
+	if (!Expand)
+	{
+		Expand = SelectExpandAStar(EMGDNMoveSet::Corners26, EMGDNStepCost::Octile, false, MinClearance > 0.f);
+	}
+
+	bool bFound = false;
+	(this->*Expand)(S, End, HeuristicWeight, MinClearance, MAX_int32, Bounds, Stats, bFound);
+
+	if (bFound)
+	{
+		S.BuildPath(End, OutIndices);
+	}
+
+	if (OutStats)
+	{
+		*OutStats = Stats;
+	}
+
+	return bFound;
+}
+
+void UMGDNRuntimeNavMesh::BeginAStar(FMGDNSearchState& S, int32 Start, int32 End, float HeuristicWeight, FMGDNSearchStats& Stats) const
+{
+	S.Begin(NumCellIndices());
+
+	int32 SX, SY, SZ;
+	FIntVector EndXYZ;
+	ToXYZ(Start, SX, SY, SZ);
+	ToXYZ(End, EndXYZ.X, EndXYZ.Y, EndXYZ.Z);
+
+	FMGDNCellRecord& StartRec = S.Visit(Start);
+	StartRec.G = 0.f;
+	const float H = PathHeuristic(Start, SX, SY, SZ, EndXYZ, GetLandmarkCosts(End));
+	S.Push(Start, HeuristicWeight * H, H);
+	Stats.Pushes++;
+}
+
+UMGDNRuntimeNavMesh::FExpandAStarFn UMGDNRuntimeNavMesh::SelectExpandAStar(
+	EMGDNMoveSet MoveSet,
+	EMGDNStepCost StepCost,
+	bool bCellCosts,
+	bool bClearance)
+{
+	// One kernel per option combination, ordered by the slot computed below
+#define MGDN_EXPAND_ASTAR(Moves, Cost) \
+	&UMGDNRuntimeNavMesh::ExpandAStar<TMGDNSearchPolicy<EMGDNMoveSet::Moves, EMGDNStepCost::Cost, false, false>>, \
+	&UMGDNRuntimeNavMesh::ExpandAStar<TMGDNSearchPolicy<EMGDNMoveSet::Moves, EMGDNStepCost::Cost, false, true>>, \
+	&UMGDNRuntimeNavMesh::ExpandAStar<TMGDNSearchPolicy<EMGDNMoveSet::Moves, EMGDNStepCost::Cost, true, false>>, \
+	&UMGDNRuntimeNavMesh::ExpandAStar<TMGDNSearchPolicy<EMGDNMoveSet::Moves, EMGDNStepCost::Cost, true, true>>
+
+	static const FExpandAStarFn Kernels[] =
+	{
+		MGDN_EXPAND_ASTAR(Faces6, Octile),    MGDN_EXPAND_ASTAR(Faces6, Unit),
+		MGDN_EXPAND_ASTAR(Edges18, Octile),   MGDN_EXPAND_ASTAR(Edges18, Unit),
+		MGDN_EXPAND_ASTAR(Corners26, Octile), MGDN_EXPAND_ASTAR(Corners26, Unit),
+	};
+
+#undef MGDN_EXPAND_ASTAR
+
+	const int32 Slot = ((int32(MoveSet) * 2 + int32(StepCost)) * 2 + int32(bCellCosts)) * 2 + int32(bClearance);
+	return Kernels[Slot];
+}
+
+template<typename FPolicy>
+bool UMGDNRuntimeNavMesh::ExpandAStar(
+	FMGDNSearchState& S,
+	int32 End,
+	float HeuristicWeight,
+	float MinClearance,
+	int32 MaxExpansions,
+	const FMGDNGridBounds* Bounds,
+	FMGDNSearchStats& Stats,
+	bool& bOutFound) const
+{
+	bOutFound = false;
+
+	FIntVector EndXYZ;
+	ToXYZ(End, EndXYZ.X, EndXYZ.Y, EndXYZ.Z);
+	const float* EndCosts = FPolicy::bLandmarks ? GetLandmarkCosts(End) : nullptr;
+
+	for (int32 Budget = MaxExpansions; Budget > 0; --Budget)
+	{
+		if (S.IsOpenEmpty())
+			return true;
+
+		const int32 Current = S.Pop();
+		Stats.Expansions++;
+
+		if (Current == End)
+		{
+			bOutFound = true;
+			return true;
+		}
+
+		const float CurrentG = S.Records[Current].G;
+
+		// Neighbour coordinates follow from the move bits, one index split per expansion
+		int32 CX, CY, CZ;
+		ToXYZ(Current, CX, CY, CZ);
+
+		uint32 Moves = GetMoveMask(Current) & FPolicy::MoveBits;
+		if (Bounds)
+		{
+			Moves = ClipMoves(Moves, CX, CY, CZ, *Bounds);
+		}
+
+		while (Moves)
+		{
+			const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+			Moves &= Moves - 1;
+
+			const int32 NIndex = StepIndex(Current, CX, CY, CZ, Bit);
+
+			if constexpr (FPolicy::bClearance)
+			{
+				if (NIndex != End && !HasClearance(NIndex, MinClearance))
+					continue;
+			}
+
+			FMGDNCellRecord& N = S.Visit(NIndex);
+
+			if (N.HeapSlot == FMGDNSearchState::ClosedSlot)
+				continue;
+
+			float Step = FPolicy::StepCost(Bit);
+			if constexpr (FPolicy::bCellCosts)
+			{
+				Step *= CellCosts[Walkable.Rank(NIndex)];
+			}
+
+			const float NewG = CurrentG + Step;
+
+			if (NewG < N.G)
+			{
+				N.G      = NewG;
+				N.Parent = Current;
+
+				const FIntVector D = FMGDNWalkableBits::BitDelta(Bit);
+				float H = FPolicy::Distance(CX + D.X - EndXYZ.X, CY + D.Y - EndXYZ.Y, CZ + D.Z - EndXYZ.Z);
+				if (EndCosts)
+				{
+					H = LandmarkHeuristic(NIndex, EndCosts, H);
+				}
+
+				S.Push(NIndex, NewG + HeuristicWeight * H, H);
+				Stats.Pushes++;
+			}
+		}
+	}
+
+	return S.IsOpenEmpty();
+}
+
+FMGDNSlicedSearch::~FMGDNSlicedSearch()
+{
+	Reset();
+}
+
+void FMGDNSlicedSearch::Reset()
+{
+	FMGDNSearchStatePool::Release(State);
+	State = nullptr;
+
+	Start  = INDEX_NONE;
+	End    = INDEX_NONE;
+	bDone  = false;
+	bFound = false;
+	Path.Reset();
+	Stats = FMGDNSearchStats();
+	HeuristicWeight = 1.f;
+	AgentRadius = 0.f;
+	MoveSet  = EMGDNMoveSet::Corners26;
+	StepCost = EMGDNStepCost::Octile;
+	bUseCellCosts = true;
+	GridVersion = 0;
+}
+
+bool UMGDNRuntimeNavMesh::BeginSlicedSearch(int32 StartIndex, int32 EndIndex, FMGDNSlicedSearch& Search,
+                                            const FMGDNPathQuery& Query) const
+{
+	Search.Reset();
+	Search.Start = StartIndex;
+	Search.End   = EndIndex;
+	Search.HeuristicWeight = FMath::Max(Query.HeuristicWeight, 1.f);
+	Search.AgentRadius     = FMath::Max(Query.AgentRadius, 0.f);
+	Search.MoveSet         = Query.MoveSet;
+	Search.StepCost        = Query.StepCost;
+	Search.bUseCellCosts   = Query.bUseCellCosts;
+	Search.GridVersion     = GridVersion;
+
+	if (!Walkable.IsValidIndex(StartIndex) || !Walkable.IsValidIndex(EndIndex) ||
+		!IsOpen(StartIndex) || !IsOpen(EndIndex))
+	{
+		Search.bDone = true;
+		return false;
+	}
+
+	// Unreachable, done before the first slice
+	if (!AreConnected(StartIndex, EndIndex))
+	{
+		Search.bDone = true;
+		return true;
+	}
+
+	if (StartIndex == EndIndex)
+	{
+		Search.Path.Add(StartIndex);
+		Search.bDone  = true;
+		Search.bFound = true;
+		return true;
+	}
+
+	return true;
+}
+
+bool UMGDNRuntimeNavMesh::StepSlicedSearch(FMGDNSlicedSearch& Search, int32 MaxExpansions) const
+{
+	if (Search.bDone)
+		return true;
+
+	// Rebuilt under the search, its records and cells belong to the old grid
+	if (Search.GridVersion != GridVersion)
+	{
+		FMGDNSearchStatePool::Release(Search.State);
+		Search.State = nullptr;
+		Search.bDone = true;
+		return true;
+	}
+
+	if (!Search.State)
+	{
+		// Borrowed for the rest of the query, it goes back to the pool of whichever thread finishes it
+		Search.State = FMGDNSearchStatePool::Acquire();
+		BeginAStar(*Search.State, Search.Start, Search.End, Search.HeuristicWeight, Search.Stats);
+	}
+
+	// Picked per slice, costs cleared between slices must not be read
+	const float MinClearance = RequiredClearance(Search.AgentRadius);
+	const FExpandAStarFn Expand = SelectExpandAStar(Search.MoveSet, Search.StepCost,
+	                                                Search.bUseCellCosts && HasCellCosts(), MinClearance > 0.f);
+
+	bool bFound = false;
+	if (!(this->*Expand)(*Search.State, Search.End, Search.HeuristicWeight, MinClearance,
+	                     MaxExpansions, nullptr, Search.Stats, bFound))
+		return false;
 
-	Walkable.SetNum(Num);
-	for (int32 i = 0; i < Num; ++i)
+	if (bFound)
 	{
-		Walkable[i] = Asset->Nodes[i].bWalkable ? 1 : 0;
+		Search.State->BuildPath(Search.End, Search.Path);
 	}
 
-	UE_LOG(LogTemp, Log,
-		TEXT("[MGDN] RuntimeNav BuildFromAsset OK Grid=%dx%dx%d Cell=%.1f Height=%.1f Walkable=%d"),
-		GridX, GridY, GridZ, CellSize, CellHeight, Num);
+	Search.bDone  = true;
+	Search.bFound = bFound;
 
+	// Finished queries hold no records, a queue of them costs nothing
+	FMGDNSearchStatePool::Release(Search.State);
+	Search.State = nullptr;
 	return true;
 }
 
-void UMGDNRuntimeNavMesh::AddNeighbors6(int32 Index, TArray<int32>& Out) const
+bool UMGDNRuntimeNavMesh::ResolveSlicedPath(const FMGDNSlicedSearch& Search, const FTransform& PlatformTransform,
+                                            const FMGDNPathQuery& Query, TArray<FVector>& OutWorldPath) const
 {
-	Out.Reset();
-
-	int32 X, Y, Z;
-	ToXYZ(Index, X, Y, Z);
+	OutWorldPath.Reset();
 
-	// 6-axis neighbors: +/-X, +/-Y, +/-Z
-	static const int32 DX[6] = { 1, -1,  0,  0,  0,  0 };
-	static const int32 DY[6] = { 0,  0,  1, -1,  0,  0 };
-	static const int32 DZ[6] = { 0,  0,  0,  0,  1, -1 };
+	if (!Search.bFound || Search.GridVersion != GridVersion)
+		return false;
 
-	for (int32 i = 0; i < 6; ++i)
+	TArray<int32> IndexPath = Search.Path;
+	if (Query.bSmoothPath)
 	{
-		const int32 NX = X + DX[i];
-		const int32 NY = Y + DY[i];
-		const int32 NZ = Z + DZ[i];
+		SmoothIndexPath(IndexPath, Query);
+	}
 
-		if (!IsValid(NX, NY, NZ))
-			continue;
+	IndexPathToWorld(PlatformTransform, IndexPath, OutWorldPath);
+	return OutWorldPath.Num() > 0;
+}
 
-		const int32 NIndex = ToIndex(NX, NY, NZ);
-		if (!Walkable.IsValidIndex(NIndex))
-			continue;
+bool UMGDNRuntimeNavMesh::FindPath(
+	const FTransform& PlatformTransform,
+	const FVector& StartWorld,
+	const FVector& EndWorld,
+	TArray<FVector>& OutWorldPath,
+	const FMGDNPathQuery& Query
+) const
+{
+	OutWorldPath.Reset();
+
+	int32 StartIndex, EndIndex;
+	if (!ResolvePathCells(PlatformTransform, StartWorld, EndWorld, StartIndex, EndIndex))
+		return false;
+
+	UE_LOG(LogTemp, Verbose,
+		TEXT("[MGDN] FindPath: Running search Start=%d End=%d"), StartIndex, EndIndex);
+
+	FMGDNPathCacheKey Key;
+	Key.Start           = StartIndex;
+	Key.End             = EndIndex;
+	Key.SearchMode      = ResolveSearchMode(Query.SearchMode);
+	Key.bSmoothPath     = Query.bSmoothPath;
+	Key.HeuristicWeight = Query.HeuristicWeight;
+	Key.MinClearance    = RequiredClearance(Query.AgentRadius);
+	Key.MoveSet         = Query.MoveSet;
+	Key.StepCost        = Query.StepCost;
+	Key.bCellCosts      = Query.bUseCellCosts && HasCellCosts();
+
+	TArray<int32> IndexPath;
+	if (!FindCachedPath(Key, IndexPath))
+	{
+		const uint32 Version = NavVersion;
 
-		if (Walkable[NIndex])
+		if (FindIndexPath(StartIndex, EndIndex, IndexPath, Query) && Query.bSmoothPath)
 		{
-			Out.Add(NIndex);
+			SmoothIndexPath(IndexPath, Query);
 		}
+
+		// Failures are cached too, an unreachable order repeated every tick costs one search
+		AddCachedPath(Key, IndexPath, Version);
+	}
+
+	if (IndexPath.Num() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[MGDN] FindPath: A* failed to find path"));
+		return false;
 	}
+
+	IndexPathToWorld(PlatformTransform, IndexPath, OutWorldPath);
+	return OutWorldPath.Num() > 0;
 }
 
-void UMGDNRuntimeNavMesh::AddNeighbors26(int32 Index, TArray<int32>& Out) const
+void UMGDNRuntimeNavMesh::MarkNavDataChanged()
 {
-	Out.Reset();
+	{
+		FScopeLock Lock(&PathCacheLock);
 
-	int32 X, Y, Z;
-	ToXYZ(Index, X, Y, Z);
+		NavVersion++;
+		PathCache.Empty(FMath::Max(PathCacheSize, 0));
+	}
 
-	for (int32 dZ = -1; dZ <= 1; dZ++)
-		for (int32 dY = -1; dY <= 1; dY++)
-			for (int32 dX = -1; dX <= 1; dX++)
-			{
-				if (dX == 0 && dY == 0 && dZ == 0)
-					continue;
+	// Fields still held elsewhere describe the old grid, FindFlowPath replaces them and FollowFlowField rejects stale moves
+	FScopeLock Lock(&FlowFieldLock);
+	FlowFields.Reset();
+}
 
-				int32 NX = X + dX;
-				int32 NY = Y + dY;
-				int32 NZ = Z + dZ;
+bool UMGDNRuntimeNavMesh::SetCellsBlocked(TConstArrayView<int32> Cells, bool bBlocked)
+{
+	if (Connectivity.Num() == 0)
+		return false;
 
-				if (!IsValid(NX, NY, NZ))
-					continue;
+	if (BakedConnectivity.Num() == 0)
+	{
+		BakedConnectivity = Connectivity;
+		BakedComponents   = Components;
+		InitCellBits(BlockedCells);
+	}
+
+	const int32 FirstChange = CellChanges.Num();
+
+	for (const int32 Index : Cells)
+	{
+		if (!Walkable.IsValidIndex(Index) || !Walkable[Index] || BlockedCells[Index] == bBlocked)
+			continue;
+
+		BlockedCells.Set(Index, bBlocked);
+		NumBlockedCells += bBlocked ? 1 : -1;
+
+		int32 X, Y, Z;
+		ToXYZ(Index, X, Y, Z);
+
+		// Baked moves are symmetric, so the baked mask also lists every neighbour with a move back into the cell
+		uint32 Moves = BakedConnectivity[Walkable.Rank(Index)];
+		uint32 Open = 0;
 
-				int32 NIndex = ToIndex(NX, NY, NZ);
-				if (Walkable[NIndex])
-					Out.Add(NIndex);
+		while (Moves)
+		{
+			const int32 Bit = int32(FMath::CountTrailingZeros(Moves));
+			Moves &= Moves - 1;
+
+			const int32 NIndex = StepIndex(Index, X, Y, Z, Bit);
+			const uint32 Back = 1u << (26 - Bit);
+			uint32& NMoves = Connectivity[Walkable.Rank(NIndex)];
+
+			if (bBlocked)
+			{
+				NMoves &= ~Back;
 			}
+			else if (!BlockedCells[NIndex])
+			{
+				NMoves |= Back;
+				Open |= 1u << Bit;
+			}
+		}
+
+		Connectivity[Walkable.Rank(Index)] = Open;
+
+		FMGDNCellChange& Change = CellChanges.AddDefaulted_GetRef();
+		Change.Cell = Index;
+	}
+
+	if (CellChanges.Num() == FirstChange)
+		return false;
+
+	// A closed door may split a region and an opened one join two, AreConnected must keep rejecting in O(1)
+	bComponentsStale.store(true, std::memory_order_release);
+
+	MarkNavDataChanged();
+
+	const int32 NumChanged = CellChanges.Num() - FirstChange;
+	for (int32 i = FirstChange; i < CellChanges.Num(); ++i)
+	{
+		CellChanges[i].Version = NavVersion;
+	}
+
+	// Keep the newer half once the log grows long, searches older than that start over
+	constexpr int32 MaxCellChanges = 8192;
+	if (CellChanges.Num() > MaxCellChanges)
+	{
+		const int32 Dropped = CellChanges.Num() - MaxCellChanges / 2;
+		CellChangesFrom = CellChanges[Dropped - 1].Version;
+		CellChanges.RemoveAt(0, Dropped, EAllowShrinking::No);
+	}
+
+	UE_LOG(LogTemp, Verbose,
+		TEXT("[MGDN] SetCellsBlocked: %d cells %s, %d blocked"),
+		NumChanged, bBlocked ? TEXT("closed") : TEXT("opened"), NumBlockedCells);
+
+	return true;
 }
 
-bool UMGDNRuntimeNavMesh::AStar(int32 Start, int32 End, TArray<int32>& OutIndices) const
+void UMGDNRuntimeNavMesh::SetCellCosts(TConstArrayView<int32> Cells, float Cost)
 {
-	OutIndices.Reset();
+	if (Connectivity.Num() == 0)
+		return;
 
-	if (Start == End)
+	// Cheaper than a plain move would let the heuristics overestimate
+	Cost = FMath::Max(Cost, 1.f);
+
+	if (CellCosts.Num() == 0)
 	{
-		OutIndices.Add(Start);
-		return true;
+		if (Cost == 1.f)
+			return;
+
+		CellCosts.Init(1.f, Connectivity.Num());
 	}
 
-	const int32 Num = GridX * GridY * GridZ;
-	if (Num <= 0)
-		return false;
+	int32 NumChanged = 0;
 
-	struct FNode
+	for (const int32 Index : Cells)
 	{
-		float G = FLT_MAX;
-		float H = 0.f;
-		int32 Parent = -1;
-		bool bOpen   = false;
-		bool bClosed = false;
-	};
+		if (!Walkable.IsValidIndex(Index) || !Walkable[Index])
+			continue;
+
+		float& CellCost = CellCosts[Walkable.Rank(Index)];
+		if (CellCost != Cost)
+		{
+			CellCost = Cost;
+			NumChanged++;
+		}
+	}
 
-	TArray<FNode> Nodes;
-	Nodes.SetNum(Num);
+	if (NumChanged == 0)
+		return;
 
-	auto Heuristic = [this](int32 A, int32 B) -> float
-	{
-		int32 AX, AY, AZ;
-		int32 BX, BY, BZ;
+	ClearPathCache();
 
-		ToXYZ(A, AX, AY, AZ);
-		ToXYZ(B, BX, BY, BZ);
+	UE_LOG(LogTemp, Verbose, TEXT("[MGDN] SetCellCosts: %d cells set to %.2f"), NumChanged, Cost);
+}
 
-		return float(
-			FMath::Abs(AX - BX) +
-			FMath::Abs(AY - BY) +
-			FMath::Abs(AZ - BZ)
-		);
-	};
+void UMGDNRuntimeNavMesh::ClearCellCosts()
+{
+	if (CellCosts.Num() == 0)
+		return;
+
+	CellCosts.Reset();
+	ClearPathCache();
+}
+
+bool UMGDNRuntimeNavMesh::SetObstacle(int32 Id, const FTransform& LocalTransform, const FVector& Extent)
+{
+	FMGDNObstacle& Obstacle = Obstacles.FindOrAdd(Id);
+	Obstacle.LocalTransform = LocalTransform;
+	Obstacle.Extent = Extent.GetAbs();
+
+	TArray<int32> Cells;
+	GatherObstacleCells(Obstacle.LocalTransform, Obstacle.Extent, Cells);
+
+	// Moved inside the same cells, nothing to restamp
+	if (Cells == Obstacle.Cells)
+		return false;
 
-	TArray<int32> OpenSet;
-	OpenSet.Reserve(128);
+	const bool bChanged = RestampObstacleCells(Obstacle.Cells, Cells);
+	Obstacle.Cells = MoveTemp(Cells);
+	return bChanged;
+}
 
-	Nodes[Start].G      = 0.f;
-	Nodes[Start].H      = Heuristic(Start, End);
-	Nodes[Start].Parent = -1;
-	Nodes[Start].bOpen  = true;
+bool UMGDNRuntimeNavMesh::RemoveObstacle(int32 Id)
+{
+	FMGDNObstacle Obstacle;
+	if (!Obstacles.RemoveAndCopyValue(Id, Obstacle))
+		return false;
 
-	OpenSet.Add(Start);
+	return RestampObstacleCells(Obstacle.Cells, TArray<int32>());
+}
 
-	TArray<int32> Neighbors;
-	Neighbors.Reserve(6);
+void UMGDNRuntimeNavMesh::GatherObstacleCells(const FTransform& LocalTransform, const FVector& Extent, TArray<int32>& OutCells) const
+{
+	OutCells.Reset();
 
-	while (OpenSet.Num() > 0)
+	if (GridX <= 0 || GridY <= 0 || GridZ <= 0 || CellSize <= 0.f || CellHeight <= 0.f)
+		return;
+
+	const FQuat Rotation = LocalTransform.GetRotation();
+	const FVector AxisX = Rotation.GetAxisX();
+	const FVector AxisY = Rotation.GetAxisY();
+	const FVector AxisZ = Rotation.GetAxisZ();
+	const FVector Center = LocalTransform.GetLocation();
+
+	// Half size of the rotated box along the platform axes, bounds the cells worth testing
+	const FVector Bounds = AxisX.GetAbs() * Extent.X + AxisY.GetAbs() * Extent.Y + AxisZ.GetAbs() * Extent.Z;
+
+	const int32 MinX = FMath::FloorToInt32((Center.X - Bounds.X + HalfSize.X) / CellSize)   - CellOffset.X;
+	const int32 MinY = FMath::FloorToInt32((Center.Y - Bounds.Y + HalfSize.Y) / CellSize)   - CellOffset.Y;
+	const int32 MinZ = FMath::FloorToInt32((Center.Z - Bounds.Z + HalfSize.Z) / CellHeight) - CellOffset.Z;
+	const int32 MaxX = FMath::FloorToInt32((Center.X + Bounds.X + HalfSize.X) / CellSize)   - CellOffset.X;
+	const int32 MaxY = FMath::FloorToInt32((Center.Y + Bounds.Y + HalfSize.Y) / CellSize)   - CellOffset.Y;
+	const int32 MaxZ = FMath::FloorToInt32((Center.Z + Bounds.Z + HalfSize.Z) / CellHeight) - CellOffset.Z;
+
+	// A cell overlaps unless its centre lies past a box face by more than the cell's own reach along that face's axis.
+	// Testing only the box axes may keep a few cells that merely touch an edge, which blocks on the safe side.
+	const FVector CellHalf(0.5f * CellSize, 0.5f * CellSize, 0.5f * CellHeight);
+	const float ReachX = Extent.X + FVector::DotProduct(AxisX.GetAbs(), CellHalf);
+	const float ReachY = Extent.Y + FVector::DotProduct(AxisY.GetAbs(), CellHalf);
+	const float ReachZ = Extent.Z + FVector::DotProduct(AxisZ.GetAbs(), CellHalf);
+
+	const FVector Base(
+		-HalfSize.X + CellSize   * (CellOffset.X + 0.5f),
+		-HalfSize.Y + CellSize   * (CellOffset.Y + 0.5f),
+		-HalfSize.Z + CellHeight * (CellOffset.Z + 0.5f));
+
+	for (int32 Z = FMath::Max(MinZ, 0); Z <= FMath::Min(MaxZ, GridZ - 1); ++Z)
+	for (int32 Y = FMath::Max(MinY, 0); Y <= FMath::Min(MaxY, GridY - 1); ++Y)
+	for (int32 X = FMath::Max(MinX, 0); X <= FMath::Min(MaxX, GridX - 1); ++X)
 	{
-		// find best F = G + H
-		int32 BestIndex = 0;
-		float BestF     = FLT_MAX;
+		const FVector D = Base + FVector(X * CellSize, Y * CellSize, Z * CellHeight) - Center;
+
+		if (FMath::Abs(FVector::DotProduct(D, AxisX)) >= ReachX ||
+			FMath::Abs(FVector::DotProduct(D, AxisY)) >= ReachY ||
+			FMath::Abs(FVector::DotProduct(D, AxisZ)) >= ReachZ)
+			continue;
+
+		OutCells.Add(ToIndex(X, Y, Z));
+	}
+
+	OutCells.Sort();
+}
 
-		for (int32 i = 0; i < OpenSet.Num(); ++i)
+bool UMGDNRuntimeNavMesh::RestampObstacleCells(const TArray<int32>& OldCells, const TArray<int32>& NewCells)
+{
+	TArray<int32> Opened;
+	TArray<int32> Closed;
+
+	// Merge of the two ascending lists, cells in both keep their count
+	int32 i = 0;
+	int32 j = 0;
+
+	while (i < OldCells.Num() || j < NewCells.Num())
+	{
+		if (j == NewCells.Num() || (i < OldCells.Num() && OldCells[i] < NewCells[j]))
 		{
-			const int32 Id = OpenSet[i];
-			const FNode& N = Nodes[Id];
-			const float F  = N.G + N.H;
+			const int32 Cell = OldCells[i++];
+			int32& Refs = ObstacleRefs.FindChecked(Cell);
 
-			if (F < BestF)
+			if (--Refs == 0)
 			{
-				BestF = F;
-				BestIndex = i;
+				ObstacleRefs.Remove(Cell);
+				Opened.Add(Cell);
 			}
 		}
-
-		const int32 Current = OpenSet[BestIndex];
-		OpenSet.RemoveAtSwap(BestIndex);
-
-		FNode& CurNode = Nodes[Current];
-		CurNode.bOpen   = false;
-		CurNode.bClosed = true;
-
-		if (Current == End)
+		else if (i == OldCells.Num() || NewCells[j] < OldCells[i])
 		{
-			int32 Trace = End;
-			while (Trace != -1)
+			const int32 Cell = NewCells[j++];
+
+			if (++ObstacleRefs.FindOrAdd(Cell, 0) == 1)
 			{
-				OutIndices.Add(Trace);
-				Trace = Nodes[Trace].Parent;
+				Closed.Add(Cell);
 			}
-			Algo::Reverse(OutIndices);
-			return true;
 		}
+		else
+		{
+			i++;
+			j++;
+		}
+	}
 
-		AddNeighbors26(Current, Neighbors);
+	const bool bOpened = SetCellsBlocked(Opened, false);
+	const bool bClosed = SetCellsBlocked(Closed, true);
 
-		for (int32 NIndex : Neighbors)
-		{
-			FNode& N = Nodes[NIndex];
+	return bOpened || bClosed;
+}
 
-			if (N.bClosed)
-				continue;
+bool UMGDNRuntimeNavMesh::GetCellChangesSince(uint32 Version, TArray<int32>& OutCells) const
+{
+	if (Version < CellChangesFrom)
+		return false;
 
-			const float NewG = CurNode.G + 1.f;
+	// Newest last, walk back until the changes were already seen
+	int32 First = CellChanges.Num();
+	while (First > 0 && CellChanges[First - 1].Version > Version)
+	{
+		First--;
+	}
 
-			if (!N.bOpen || NewG < N.G)
-			{
-				N.G      = NewG;
-				N.H      = Heuristic(NIndex, End);
-				N.Parent = Current;
+	for (int32 i = First; i < CellChanges.Num(); ++i)
+	{
+		OutCells.Add(CellChanges[i].Cell);
+	}
 
-				if (!N.bOpen)
-				{
-					N.bOpen = true;
-					OpenSet.Add(NIndex);
-				}
-			}
-		}
+	return true;
+}
+
+FMGDNPathCacheStats UMGDNRuntimeNavMesh::GetPathCacheStats() const
+{
+	FScopeLock Lock(&PathCacheLock);
+
+	FMGDNPathCacheStats Stats = PathCacheStats;
+	Stats.Entries = PathCache.Num();
+	return Stats;
+}
+
+bool UMGDNRuntimeNavMesh::FindCachedPath(const FMGDNPathCacheKey& Key, TArray<int32>& OutIndices) const
+{
+	if (PathCacheSize <= 0)
+		return false;
+
+	FScopeLock Lock(&PathCacheLock);
+
+	if (const TArray<int32>* Cached = PathCache.FindAndTouch(Key))
+	{
+		OutIndices = *Cached;
+		PathCacheStats.Hits++;
+		return true;
 	}
 
+	PathCacheStats.Misses++;
 	return false;
 }
 
-bool UMGDNRuntimeNavMesh::FindPath(
+void UMGDNRuntimeNavMesh::AddCachedPath(const FMGDNPathCacheKey& Key, const TArray<int32>& Indices, uint32 Version) const
+{
+	if (PathCacheSize <= 0)
+		return;
+
+	FScopeLock Lock(&PathCacheLock);
+
+	// Searched on a grid that changed while the search ran
+	if (Version != NavVersion || PathCache.Max() <= 0)
+		return;
+
+	PathCache.Add(Key, Indices);
+}
+
+void UMGDNRuntimeNavMesh::ClearPathCache()
+{
+	FScopeLock Lock(&PathCacheLock);
+	PathCache.Empty(FMath::Max(PathCacheSize, 0));
+}
+
+bool UMGDNRuntimeNavMesh::HasLineOfSight(int32 From, int32 To, float AgentRadius) const
+{
+	return TraceLineOfSight(From, To, RequiredClearance(AgentRadius),
+		MGDNSearchPolicies::MoveBitsOf(EMGDNMoveSet::Corners26), false);
+}
+
+bool UMGDNRuntimeNavMesh::HasLineOfSight(int32 From, int32 To, const FMGDNPathQuery& Query) const
+{
+	return TraceLineOfSight(From, To, RequiredClearance(Query.AgentRadius),
+		MGDNSearchPolicies::MoveBitsOf(Query.MoveSet), Query.bUseCellCosts && HasCellCosts());
+}
+
+bool UMGDNRuntimeNavMesh::TraceLineOfSight(int32 From, int32 To, float MinClearance, uint32 MoveBits, bool bCellCosts) const
+{
+	int32 X, Y, Z;
+	int32 EX, EY, EZ;
+	ToXYZ(From, X, Y, Z);
+	ToXYZ(To, EX, EY, EZ);
+
+	const int32 SX = FMath::Sign(EX - X);
+	const int32 SY = FMath::Sign(EY - Y);
+	const int32 SZ = FMath::Sign(EZ - Z);
+
+	// 3D DDA from centre to centre. The line crosses the k-th boundary of an axis at
+	// t = (2k+1) / (2|D|), kept as exact fractions so lines through edges and corners are
+	// seen as one diagonal move instead of depending on float rounding.
+	const int64 DenX = 2 * FMath::Abs(EX - X);
+	const int64 DenY = 2 * FMath::Abs(EY - Y);
+	const int64 DenZ = 2 * FMath::Abs(EZ - Z);
+
+	int64 NumX = 1, NumY = 1, NumZ = 1;
+
+	// A < B for crossings NumA/DenA and NumB/DenB, axes that never cross compare as infinite
+	auto Earlier = [](int64 NumA, int64 DenA, int64 NumB, int64 DenB)
+	{
+		if (DenA == 0) return false;
+		if (DenB == 0) return true;
+		return NumA * DenB < NumB * DenA;
+	};
+
+	auto Same = [](int64 NumA, int64 DenA, int64 NumB, int64 DenB)
+	{
+		return DenA != 0 && DenB != 0 && NumA * DenB == NumB * DenA;
+	};
+
+	int32 Index = From;
+
+	while (X != EX || Y != EY || Z != EZ)
+	{
+		// Axis crossing first, plus every axis crossing at the same moment
+		int64 Num = NumX, Den = DenX;
+		if (Earlier(NumY, DenY, Num, Den)) { Num = NumY; Den = DenY; }
+		if (Earlier(NumZ, DenZ, Num, Den)) { Num = NumZ; Den = DenZ; }
+
+		const int32 MX = Same(NumX, DenX, Num, Den) ? SX : 0;
+		const int32 MY = Same(NumY, DenY, Num, Den) ? SY : 0;
+		const int32 MZ = Same(NumZ, DenZ, Num, Den) ? SZ : 0;
+
+		// The same rules as a path step, so steps, deck changes and the query's moves block the line like they block A*
+		const int32 Bit = FMGDNWalkableBits::BitOf(MX, MY, MZ);
+		if (!(((GetMoveMask(Index) & MoveBits) >> Bit) & 1))
+			return false;
+
+		Index = StepIndex(Index, X, Y, Z, Bit);
+
+		if (Index != To && !HasClearance(Index, MinClearance))
+			return false;
+
+		// A shortcut over a costly cell may cost more than the cheap cells the path went around it by
+		if (bCellCosts && Index != To && CellCosts[Walkable.Rank(Index)] > 1.f)
+			return false;
+
+		X += MX;
+		Y += MY;
+		Z += MZ;
+
+		if (MX) NumX += 2;
+		if (MY) NumY += 2;
+		if (MZ) NumZ += 2;
+	}
+
+	return true;
+}
+
+void UMGDNRuntimeNavMesh::SmoothIndexPath(TArray<int32>& InOutIndices, float AgentRadius) const
+{
+	PullIndexPath(InOutIndices, RequiredClearance(AgentRadius), MGDNSearchPolicies::MoveBitsOf(EMGDNMoveSet::Corners26), false);
+}
+
+void UMGDNRuntimeNavMesh::SmoothIndexPath(TArray<int32>& InOutIndices, const FMGDNPathQuery& Query) const
+{
+	PullIndexPath(InOutIndices, RequiredClearance(Query.AgentRadius),
+		MGDNSearchPolicies::MoveBitsOf(Query.MoveSet), Query.bUseCellCosts && HasCellCosts());
+}
+
+void UMGDNRuntimeNavMesh::PullIndexPath(TArray<int32>& InOutIndices, float MinClearance, uint32 MoveBits, bool bCellCosts) const
+{
+	if (InOutIndices.Num() < 3)
+		return;
+
+	// Kept cells are compacted to the front, Anchor is the last one kept
+	int32 Kept = 1;
+	int32 Anchor = InOutIndices[0];
+
+	for (int32 i = 2; i < InOutIndices.Num(); ++i)
+	{
+		if (!TraceLineOfSight(Anchor, InOutIndices[i], MinClearance, MoveBits, bCellCosts))
+		{
+			Anchor = InOutIndices[i - 1];
+			InOutIndices[Kept++] = Anchor;
+		}
+	}
+
+	InOutIndices[Kept++] = InOutIndices.Last();
+	InOutIndices.SetNum(Kept, EAllowShrinking::No);
+}
+
+bool UMGDNRuntimeNavMesh::ResolvePathCells(
 	const FTransform& PlatformTransform,
 	const FVector& StartWorld,
 	const FVector& EndWorld,
-	TArray<FVector>& OutWorldPath
-) const
+	int32& OutStartIndex,
+	int32& OutEndIndex) const
 {
-	OutWorldPath.Reset();
-
 	if (GridX <= 0 || GridY <= 0 || GridZ <= 0 || CellSize <= 0.f || CellHeight <= 0.f)
 	{
 		UE_LOG(LogTemp, Error,
@@ -244,7 +1469,7 @@ bool UMGDNRuntimeNavMesh::FindPath(
 		return false;
 	}
 
-	const int32 Num = GridX * GridY * GridZ;
+	const int32 Num = NumCellIndices();
 	if (Walkable.Num() != Num)
 	{
 		UE_LOG(LogTemp, Error,
@@ -258,9 +1483,9 @@ bool UMGDNRuntimeNavMesh::FindPath(
 
 	auto MapToGrid = [this](const FVector& P, int32& GX, int32& GY, int32& GZ)
 	{
-		GX = FMath::Clamp(int32((P.X + HalfSize.X) / CellSize),   0, GridX - 1);
-		GY = FMath::Clamp(int32((P.Y + HalfSize.Y) / CellSize),   0, GridY - 1);
-		GZ = FMath::Clamp(int32((P.Z + HalfSize.Z) / CellHeight), 0, GridZ - 1);
+		GX = FMath::Clamp(int32((P.X + HalfSize.X) / CellSize)   - CellOffset.X, 0, GridX - 1);
+		GY = FMath::Clamp(int32((P.Y + HalfSize.Y) / CellSize)   - CellOffset.Y, 0, GridY - 1);
+		GZ = FMath::Clamp(int32((P.Z + HalfSize.Z) / CellHeight) - CellOffset.Z, 0, GridZ - 1);
 	};
 
 	int32 SX, SY, SZ;
@@ -280,9 +1505,13 @@ bool UMGDNRuntimeNavMesh::FindPath(
 	 int32 StartIndex = ToIndex(SX, SY, SZ);
 	 int32 EndIndex   = ToIndex(EX, EY, EZ);
 
-	if (!Walkable.IsValidIndex(StartIndex) || !Walkable[StartIndex])
+	const bool bEndWalkable = Walkable.IsValidIndex(EndIndex) && IsOpen(EndIndex);
+
+	if (!Walkable.IsValidIndex(StartIndex) || !IsOpen(StartIndex))
 	{
-		const int32 Fallback = FindNearestWalkable(SX, SY, SZ, 2);
+		// Prefer a cell the goal can be reached from
+		const int32 Fallback = FindNearestWalkable(SX, SY, SZ, 2,
+			bEndWalkable ? GetComponent(EndIndex) : INDEX_NONE);
 
 		if (Fallback < 0)
 		{
@@ -299,9 +1528,24 @@ bool UMGDNRuntimeNavMesh::FindPath(
 	}
 
 	// --- END CELL VALIDATION WITH FALLBACK ---
-	if (!Walkable.IsValidIndex(EndIndex) || !Walkable[EndIndex])
+	const int32 StartComponent = GetComponent(StartIndex);
+
+	if (bEndWalkable && GetComponent(EndIndex) != StartComponent)
+	{
+		// Goal on an island the start cannot reach, a nearby reachable cell beats failing the query
+		const int32 Reachable = FindNearestWalkable(EX, EY, EZ, 2, StartComponent);
+
+		if (Reachable >= 0 && GetComponent(Reachable) == StartComponent)
+		{
+			UE_LOG(LogTemp, Display,
+				TEXT("[MGDN] FindPath: End unreachable, reachable neighbour used → %d"), Reachable);
+
+			EndIndex = Reachable;
+		}
+	}
+	else if (!bEndWalkable)
 	{
-		const int32 FallbackEnd = FindNearestWalkable(EX, EY, EZ, 2);
+		const int32 FallbackEnd = FindNearestWalkable(EX, EY, EZ, 2, StartComponent);
 
 		if (FallbackEnd < 0)
 		{
@@ -317,38 +1561,33 @@ bool UMGDNRuntimeNavMesh::FindPath(
 		EndIndex = FallbackEnd;
 	}
 
+	OutStartIndex = StartIndex;
+	OutEndIndex   = EndIndex;
+	return true;
+}
 
-	UE_LOG(LogTemp, Verbose,
-		TEXT("[MGDN] FindPath: Running A* Start=%d End=%d"), StartIndex, EndIndex);
-
-	TArray<int32> IndexPath;
-	if (!AStar(StartIndex, EndIndex, IndexPath) || IndexPath.Num() == 0)
-	{
-		UE_LOG(LogTemp, Warning, TEXT("[MGDN] FindPath: A* failed to find path"));
-		return false;
-	}
-
-	// Convert indices back to world points (voxel centers)
-	const float BaseX = -HalfSize.X + CellSize   * 0.5f;
-	const float BaseY = -HalfSize.Y + CellSize   * 0.5f;
-	const float BaseZ = -HalfSize.Z + CellHeight * 0.5f;
-
+void UMGDNRuntimeNavMesh::IndexPathToWorld(
+	const FTransform& PlatformTransform,
+	const TArray<int32>& IndexPath,
+	TArray<FVector>& OutWorldPath) const
+{
+	OutWorldPath.Reset();
 	OutWorldPath.Reserve(IndexPath.Num());
 
+	// Convert indices back to world points (voxel centers)
 	for (int32 Id : IndexPath)
 	{
-		int32 GX, GY, GZ;
-		ToXYZ(Id, GX, GY, GZ);
-
-		const float LX = BaseX + GX * CellSize;
-		const float LY = BaseY + GY * CellSize;
-		const float LZ = BaseZ + GZ * CellHeight;
-
-		const FVector Local(LX, LY, LZ);
-		const FVector World = PlatformTransform.TransformPosition(Local);
-
-		OutWorldPath.Add(World);
+		OutWorldPath.Add(PlatformTransform.TransformPosition(GetCellCenterLocal(Id)));
 	}
+}
 
-	return OutWorldPath.Num() > 0;
+FVector UMGDNRuntimeNavMesh::GetCellCenterLocal(int32 Index) const
+{
+	int32 GX, GY, GZ;
+	ToXYZ(Index, GX, GY, GZ);
+
+	return FVector(
+		-HalfSize.X + CellSize   * (CellOffset.X + GX + 0.5f),
+		-HalfSize.Y + CellSize   * (CellOffset.Y + GY + 0.5f),
+		-HalfSize.Z + CellHeight * (CellOffset.Z + GZ + 0.5f));
 }
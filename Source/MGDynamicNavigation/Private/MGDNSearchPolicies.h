@@ -0,0 +1,125 @@
+﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
+#pragma once
+#include "CoreMinimal.h"
+#include "MGDNRuntimeNavMesh.h"
+#include "MGDNWalkableBits.h"
+
+namespace MGDNSearchPolicies
+{
+	// Coordinates the move of a NeighborMask bit changes
+	constexpr int32 AxesOf(int32 Bit)
+	{
+		return (Bit % 3 != 1) + ((Bit / 3) % 3 != 1) + (Bit / 9 != 1);
+	}
+
+	// NeighborMask bits of the moves that change at most MaxAxes coordinates
+	constexpr uint32 MovesAlong(int32 MaxAxes)
+	{
+		uint32 Mask = 0;
+		for (int32 Bit = 0; Bit < 27; ++Bit)
+		{
+			if (AxesOf(Bit) > 0 && AxesOf(Bit) <= MaxAxes)
+				Mask |= 1u << Bit;
+		}
+		return Mask;
+	}
+
+	// NeighborMask bits of the moves MoveSet allows
+	constexpr uint32 MoveBitsOf(EMGDNMoveSet MoveSet)
+	{
+		return MovesAlong(MoveSet == EMGDNMoveSet::Faces6 ? 1 : MoveSet == EMGDNMoveSet::Edges18 ? 2 : 3);
+	}
+
+	// Length in cells of the move of every NeighborMask bit
+	struct FMoveLengths
+	{
+		float Of[27] = {};
+	};
+
+	constexpr FMoveLengths MakeMoveLengths()
+	{
+		constexpr float Lengths[4] = { 0.f, 1.f, UE_SQRT_2, UE_SQRT_3 };
+
+		FMoveLengths Out;
+		for (int32 Bit = 0; Bit < 27; ++Bit)
+		{
+			Out.Of[Bit] = Lengths[AxesOf(Bit)];
+		}
+		return Out;
+	}
+
+	inline constexpr FMoveLengths MoveLengths = MakeMoveLengths();
+}
+
+/**
+ * Compile time options of one A* kernel, see UMGDNRuntimeNavMesh::ExpandAStar.
+ * Every option is a constant of the type so the expansion loop carries no branch or call for it.
+ */
+template<EMGDNMoveSet InMoveSet, EMGDNStepCost InStepCost, bool bInCellCosts, bool bInClearance>
+struct TMGDNSearchPolicy
+{
+	// Moves of the baked move mask the search may take
+	static constexpr uint32 MoveBits = MGDNSearchPolicies::MoveBitsOf(InMoveSet);
+
+	// Scale moves by UMGDNRuntimeNavMesh::GetCellCost of the cell they enter
+	static constexpr bool bCellCosts = bInCellCosts;
+
+	// Skip cells below the query's clearance
+	static constexpr bool bClearance = bInClearance;
+
+	// Landmark costs are octile path lengths, a lower bound on octile paths only
+	static constexpr bool bLandmarks = InStepCost == EMGDNStepCost::Octile;
+
+	static FORCEINLINE float StepCost(int32 Bit)
+	{
+		if constexpr (InStepCost == EMGDNStepCost::Unit)
+		{
+			return 1.f;
+		}
+		else
+		{
+			return MGDNSearchPolicies::MoveLengths.Of[Bit];
+		}
+	}
+
+	// Cheapest path over an open grid with these moves and costs, so never more than any real path
+	static FORCEINLINE float Distance(int32 DX, int32 DY, int32 DZ)
+	{
+		int32 A = FMath::Abs(DX);
+		int32 B = FMath::Abs(DY);
+		int32 C = FMath::Abs(DZ);
+
+		if constexpr (InMoveSet == EMGDNMoveSet::Faces6)
+		{
+			return float(A + B + C);
+		}
+		else
+		{
+			// A >= B >= C
+			if (A < B) Swap(A, B);
+			if (B < C) Swap(B, C);
+			if (A < B) Swap(A, B);
+
+			const int32 Sum = A + B + C;
+
+			if constexpr (InMoveSet == EMGDNMoveSet::Corners26)
+			{
+				return InStepCost == EMGDNStepCost::Unit
+					? float(A)
+					: A + (UE_SQRT_2 - 1.f) * B + (UE_SQRT_3 - UE_SQRT_2) * C;
+			}
+			else if constexpr (InStepCost == EMGDNStepCost::Unit)
+			{
+				// An edge move changes two coordinates, never one twice
+				return float(FMath::Max(A, (Sum + 1) / 2));
+			}
+			else
+			{
+				// Pair A off with B and C while it is the longest, otherwise every move but one can be an edge move
+				return A >= B + C
+					? A + (UE_SQRT_2 - 1.f) * (B + C)
+					: (Sum / 2) * UE_SQRT_2 + (Sum & 1);
+			}
+		}
+	}
+};
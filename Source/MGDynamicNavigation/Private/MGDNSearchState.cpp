@@ -0,0 +1,207 @@
+﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
+#include "MGDNSearchState.h"
+#include "Algo/Reverse.h"
+
+void FMGDNSearchState::Begin(int32 NumCells)
+{
+	if (Records.Num() < NumCells)
+	{
+		// New records start at generation 0, which no running search ever uses
+		Records.SetNum(NumCells);
+	}
+
+	++Generation;
+	if (Generation == 0)
+	{
+		// Wrapped around, old stamps could alias the new generation
+		for (FMGDNCellRecord& R : Records)
+		{
+			R.Generation = 0;
+		}
+		Generation = 1;
+	}
+
+	Heap.Reset();
+}
+
+void FMGDNSearchState::Push(int32 Cell, float F, float H)
+{
+	const int32 Slot = Records[Cell].HeapSlot;
+
+	FMGDNHeapEntry Entry;
+	Entry.F    = F;
+	Entry.H    = H;
+	Entry.Cell = Cell;
+
+	if (Slot >= 0)
+	{
+		if (Entry.PopsBefore(Heap[Slot]))
+		{
+			Heap[Slot] = Entry;
+			SiftUp(Slot);
+		}
+		return;
+	}
+
+	Heap.Add(Entry);
+	Records[Cell].HeapSlot = Heap.Num() - 1;
+	SiftUp(Heap.Num() - 1);
+}
+
+void FMGDNSearchState::Update(int32 Cell, float F, float H)
+{
+	const int32 Slot = Records[Cell].HeapSlot;
+	if (Slot < 0)
+	{
+		Push(Cell, F, H);
+		return;
+	}
+
+	FMGDNHeapEntry Entry;
+	Entry.F    = F;
+	Entry.H    = H;
+	Entry.Cell = Cell;
+
+	const bool bRaised = Heap[Slot].PopsBefore(Entry);
+	Heap[Slot] = Entry;
+
+	if (bRaised)
+		SiftDown(Slot);
+	else
+		SiftUp(Slot);
+}
+
+void FMGDNSearchState::Remove(int32 Cell)
+{
+	const int32 Slot = Records[Cell].HeapSlot;
+	if (Slot < 0)
+		return;
+
+	Records[Cell].HeapSlot = INDEX_NONE;
+
+	const FMGDNHeapEntry Last = Heap.Pop(EAllowShrinking::No);
+	if (Slot < Heap.Num())
+	{
+		// The last entry may belong above or below the hole it fills
+		const bool bRaised = Heap[Slot].PopsBefore(Last);
+		Place(Slot, Last);
+
+		if (bRaised)
+			SiftDown(Slot);
+		else
+			SiftUp(Slot);
+	}
+}
+
+int32 FMGDNSearchState::Pop()
+{
+	const int32 Cell = Heap[0].Cell;
+	Records[Cell].HeapSlot = ClosedSlot;
+
+	const FMGDNHeapEntry Last = Heap.Pop(EAllowShrinking::No);
+	if (Heap.Num() > 0)
+	{
+		Place(0, Last);
+		SiftDown(0);
+	}
+
+	return Cell;
+}
+
+void FMGDNSearchState::SiftUp(int32 Slot)
+{
+	const FMGDNHeapEntry Entry = Heap[Slot];
+
+	while (Slot > 0)
+	{
+		const int32 ParentSlot = (Slot - 1) / Arity;
+		if (!Entry.PopsBefore(Heap[ParentSlot]))
+			break;
+
+		Place(Slot, Heap[ParentSlot]);
+		Slot = ParentSlot;
+	}
+
+	Place(Slot, Entry);
+}
+
+void FMGDNSearchState::SiftDown(int32 Slot)
+{
+	const FMGDNHeapEntry Entry = Heap[Slot];
+	const int32 Count = Heap.Num();
+
+	for (;;)
+	{
+		const int32 First = Slot * Arity + 1;
+		if (First >= Count)
+			break;
+
+		const int32 End = FMath::Min(First + Arity, Count);
+
+		int32 Best = First;
+		for (int32 Child = First + 1; Child < End; ++Child)
+		{
+			if (Heap[Child].PopsBefore(Heap[Best]))
+				Best = Child;
+		}
+
+		if (!Heap[Best].PopsBefore(Entry))
+			break;
+
+		Place(Slot, Heap[Best]);
+		Slot = Best;
+	}
+
+	Place(Slot, Entry);
+}
+
+void FMGDNSearchState::BuildPath(int32 Cell, TArray<int32>& OutIndices) const
+{
+	OutIndices.Reset();
+
+	for (int32 Trace = Cell; Trace != INDEX_NONE; Trace = Records[Trace].Parent)
+	{
+		OutIndices.Add(Trace);
+	}
+
+	Algo::Reverse(OutIndices);
+}
+
+namespace
+{
+	// States owned by this thread that are not borrowed right now
+	struct FMGDNThreadStates
+	{
+		TArray<TUniquePtr<FMGDNSearchState>> Free;
+	};
+
+	thread_local FMGDNThreadStates ThreadStates;
+}
+
+FMGDNSearchState* FMGDNSearchStatePool::Acquire()
+{
+	if (ThreadStates.Free.Num() > 0)
+	{
+		return ThreadStates.Free.Pop(EAllowShrinking::No).Release();
+	}
+
+	return new FMGDNSearchState();
+}
+
+void FMGDNSearchStatePool::Release(FMGDNSearchState* State)
+{
+	if (!State)
+		return;
+
+	// A state holds records for every cell, spares past a few nested searches would stay allocated for good
+	constexpr int32 MaxFreeStates = 4;
+
+	if (ThreadStates.Free.Num() < MaxFreeStates)
+	{
+		ThreadStates.Free.Add(TUniquePtr<FMGDNSearchState>(State));
+	}
+	else
+	{
+		delete State;
+	}
+}
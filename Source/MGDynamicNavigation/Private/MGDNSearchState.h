@@ -0,0 +1,147 @@
+﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Per cell bookkeeping of a grid search.
+ * A record only counts as visited when its Generation matches the search that reads it,
+ * so stale records from earlier queries never need to be cleared.
+ */
+struct FMGDNCellRecord
+{
+	float G = 0.f;
+	int32 Parent = INDEX_NONE;
+
+	// Slot in the open heap, INDEX_NONE when not queued, ClosedSlot once expanded
+	int32 HeapSlot = INDEX_NONE;
+
+	uint32 Generation = 0;
+};
+
+struct FMGDNHeapEntry
+{
+	float F = 0.f;
+
+	// Heuristic part of F, equal F pops the entry closer to the goal first
+	float H = 0.f;
+
+	int32 Cell = INDEX_NONE;
+
+	FORCEINLINE bool PopsBefore(const FMGDNHeapEntry& Other) const
+	{
+		return F < Other.F || (F == Other.F && H < Other.H);
+	}
+};
+
+/**
+ * Reusable state of a single grid search: cell records plus an indexed d-ary open heap
+ * with decrease-key. Obtain one through FMGDNScopedSearchState instead of constructing it.
+ */
+struct FMGDNSearchState
+{
+	static constexpr int32 Arity = 4;
+	static constexpr int32 ClosedSlot = -2;
+
+	TArray<FMGDNCellRecord> Records;
+	TArray<FMGDNHeapEntry> Heap;
+	uint32 Generation = 0;
+
+	/** Starts a new search over NumCells cells. Old records are invalidated by bumping the generation. */
+	void Begin(int32 NumCells);
+
+	FORCEINLINE bool IsVisited(int32 Cell) const
+	{
+		return Records[Cell].Generation == Generation;
+	}
+
+	FORCEINLINE bool IsClosed(int32 Cell) const
+	{
+		const FMGDNCellRecord& R = Records[Cell];
+		return R.Generation == Generation && R.HeapSlot == ClosedSlot;
+	}
+
+	/** Returns the record of Cell, resetting it first if it belongs to an older search. */
+	FORCEINLINE FMGDNCellRecord& Visit(int32 Cell)
+	{
+		FMGDNCellRecord& R = Records[Cell];
+		if (R.Generation != Generation)
+		{
+			R.G          = FLT_MAX;
+			R.Parent     = INDEX_NONE;
+			R.HeapSlot   = INDEX_NONE;
+			R.Generation = Generation;
+		}
+		return R;
+	}
+
+	FORCEINLINE bool IsOpenEmpty() const { return Heap.Num() == 0; }
+
+	/** Lowest priority in the open heap, the heap must not be empty. */
+	FORCEINLINE float PeekF() const { return Heap[0].F; }
+
+	/** Tie breaker of the lowest priority entry, the heap must not be empty. */
+	FORCEINLINE float PeekH() const { return Heap[0].H; }
+
+	/** Cell of the lowest priority entry, the heap must not be empty. */
+	FORCEINLINE int32 PeekCell() const { return Heap[0].Cell; }
+
+	FORCEINLINE bool IsQueued(int32 Cell) const
+	{
+		const FMGDNCellRecord& R = Records[Cell];
+		return R.Generation == Generation && R.HeapSlot >= 0;
+	}
+
+	/** Queues Cell with priority F, or lowers its priority if it is already queued. H breaks ties between equal F. */
+	void Push(int32 Cell, float F, float H = 0.f);
+
+	/** Queues Cell with priority F, or moves it to F in either direction if it is already queued. */
+	void Update(int32 Cell, float F, float H = 0.f);
+
+	/** Takes Cell out of the heap without closing it, nothing happens when it is not queued. */
+	void Remove(int32 Cell);
+
+	/** Removes the lowest priority cell from the heap and marks it closed. */
+	int32 Pop();
+
+	/** Walks parents back from Cell and writes the path in start to end order. */
+	void BuildPath(int32 Cell, TArray<int32>& OutIndices) const;
+
+private:
+
+	void SiftUp(int32 Slot);
+	void SiftDown(int32 Slot);
+
+	FORCEINLINE void Place(int32 Slot, const FMGDNHeapEntry& Entry)
+	{
+		Heap[Slot] = Entry;
+		Records[Entry.Cell].HeapSlot = Slot;
+	}
+};
+
+/**
+ * Per thread pool of search states. States keep their allocations between queries,
+ * so a search on a thread that has run one before allocates nothing. Each thread keeps
+ * at most MaxFreeStates of them, the rest of a burst of concurrent searches is freed.
+ */
+class FMGDNSearchStatePool
+{
+public:
+	static FMGDNSearchState* Acquire();
+	static void Release(FMGDNSearchState* State);
+};
+
+/** Borrows a search state from the calling thread's pool for the lifetime of the scope. */
+struct FMGDNScopedSearchState
+{
+	FMGDNScopedSearchState() : State(FMGDNSearchStatePool::Acquire()) {}
+	~FMGDNScopedSearchState() { FMGDNSearchStatePool::Release(State); }
+
+	FMGDNScopedSearchState(const FMGDNScopedSearchState&) = delete;
+	FMGDNScopedSearchState& operator=(const FMGDNScopedSearchState&) = delete;
+
+	FMGDNSearchState& operator*() const { return *State; }
+	FMGDNSearchState* operator->() const { return State; }
+
+private:
+	FMGDNSearchState* State;
+};
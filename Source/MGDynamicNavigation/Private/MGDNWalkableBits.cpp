@@ -0,0 +1,155 @@
+﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
+#include "MGDNWalkableBits.h"
+
+#if PLATFORM_ALWAYS_HAS_AVX_2
+#include <immintrin.h>
+#elif PLATFORM_CPU_X86_FAMILY && PLATFORM_ENABLE_VECTORINTRINSICS
+#include <emmintrin.h>
+#endif
+
+// Row reads load 32 bits from a byte address and shift, which needs little endian word order
+static_assert(PLATFORM_LITTLE_ENDIAN, "FMGDNWalkableBits expects a little endian platform");
+
+namespace
+{
+	// Three cells starting at bit Pos as the low 3 bits
+	FORCEINLINE uint32 ReadRow(const uint8* Bytes, int32 Pos)
+	{
+		uint32 Word;
+		FMemory::Memcpy(&Word, Bytes + (Pos >> 3), sizeof(Word));
+		return (Word >> (Pos & 7)) & 7;
+	}
+
+#if !PLATFORM_ALWAYS_HAS_AVX_2 && PLATFORM_CPU_X86_FAMILY && PLATFORM_ENABLE_VECTORINTRINSICS
+	// Rows FirstRow..FirstRow+3 at bits Row * 3 of the low 32 bits. SSE2 has no gather and no per lane shifts, so each
+	// loaded word is multiplied by 2^(7 + Row * 3 - Shift), built from a float exponent. The 64-bit products are exact,
+	// the multiply is a left shift that puts the row's three cells at bit 7 + Row * 3.
+	FORCEINLINE __m128i ReadRows4(const uint8* Bytes, int32 Base, const int32* RowDelta, int32 FirstRow)
+	{
+		alignas(16) int32 Pos[4];
+		alignas(16) uint32 Words[4];
+		for (int32 i = 0; i < 4; ++i)
+		{
+			Pos[i] = Base + RowDelta[FirstRow + i];
+			FMemory::Memcpy(&Words[i], Bytes + (Pos[i] >> 3), sizeof(uint32));
+		}
+
+		const int32 Place = 127 + 7 + FirstRow * 3;
+		const __m128i Shift = _mm_and_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(Pos)), _mm_set1_epi32(7));
+		const __m128i Exp   = _mm_sub_epi32(_mm_setr_epi32(Place, Place + 3, Place + 6, Place + 9), Shift);
+		const __m128i Scale = _mm_cvttps_epi32(_mm_castsi128_ps(_mm_slli_epi32(Exp, 23)));
+
+		const __m128i Loaded = _mm_load_si128(reinterpret_cast<const __m128i*>(Words));
+		const __m128i Even   = _mm_mul_epu32(Loaded, Scale);
+		const __m128i Odd    = _mm_mul_epu32(_mm_srli_epi64(Loaded, 32), _mm_srli_epi64(Scale, 32));
+
+		const uint64 Cells = 7ull << (7 + FirstRow * 3);
+		__m128i Rows = _mm_or_si128(
+			_mm_and_si128(Even, _mm_set_epi64x(int64(Cells << 6), int64(Cells))),
+			_mm_and_si128(Odd,  _mm_set_epi64x(int64(Cells << 9), int64(Cells << 3))));
+
+		Rows = _mm_or_si128(Rows, _mm_shuffle_epi32(Rows, _MM_SHUFFLE(1, 0, 3, 2)));
+		return _mm_srli_epi64(Rows, 7);
+	}
+#endif
+}
+
+void FMGDNWalkableBits::Init(int32 InGridX, int32 InGridY, int32 InGridZ)
+{
+	GridX    = InGridX;
+	GridY    = InGridY;
+	NumCells = InGridX * InGridY * InGridZ;
+
+	const int32 XYCount = GridX * GridY;
+
+	// Reads reach one layer, one row and one cell to either side of the grid
+	PadBits = Align(XYCount + GridX + 1, 64);
+
+	Words.Reset();
+	Words.SetNumZeroed((PadBits * 2 + NumCells) / 64 + 2);
+
+	for (int32 DZ = -1; DZ <= 1; ++DZ)
+	{
+		for (int32 DY = -1; DY <= 1; ++DY)
+		{
+			RowDelta[(DY + 1) + (DZ + 1) * 3] = DY * GridX + DZ * XYCount;
+		}
+	}
+}
+
+void FMGDNWalkableBits::Reset()
+{
+	Words.Reset();
+	WordRanks.Reset();
+	NumCells = 0;
+	GridX    = 0;
+	GridY    = 0;
+	PadBits  = 0;
+}
+
+uint32 FMGDNWalkableBits::NeighborMask(int32 Index, int32 X, int32 Y) const
+{
+	const uint8* Bytes = reinterpret_cast<const uint8*>(Words.GetData());
+
+	// Bit of the X-1 cell in the centre row
+	const int32 Base = Index + PadBits - 1;
+
+	uint32 Mask;
+
+#if PLATFORM_ALWAYS_HAS_AVX_2
+	// Rows 0-7 in one gather, each lane then shifts its three cells into place
+	const __m256i Pos    = _mm256_add_epi32(_mm256_set1_epi32(Base), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(RowDelta)));
+	const __m256i Loaded = _mm256_i32gather_epi32(reinterpret_cast<const int*>(Bytes), _mm256_srli_epi32(Pos, 3), 1);
+	const __m256i Shift  = _mm256_and_si256(Pos, _mm256_set1_epi32(7));
+
+	__m256i Rows = _mm256_and_si256(_mm256_srlv_epi32(Loaded, Shift), _mm256_set1_epi32(7));
+	Rows = _mm256_sllv_epi32(Rows, _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21));
+
+	__m128i Merged = _mm_or_si128(_mm256_castsi256_si128(Rows), _mm256_extracti128_si256(Rows, 1));
+	Merged = _mm_or_si128(Merged, _mm_shuffle_epi32(Merged, _MM_SHUFFLE(1, 0, 3, 2)));
+	Merged = _mm_or_si128(Merged, _mm_shuffle_epi32(Merged, _MM_SHUFFLE(2, 3, 0, 1)));
+
+	Mask = uint32(_mm_cvtsi128_si32(Merged)) | (ReadRow(Bytes, Base + RowDelta[8]) << 24);
+#elif PLATFORM_CPU_X86_FAMILY && PLATFORM_ENABLE_VECTORINTRINSICS
+	// Every x64 target has SSE2, rows 0-7 four at a time
+	const __m128i Rows = _mm_or_si128(ReadRows4(Bytes, Base, RowDelta, 0), ReadRows4(Bytes, Base, RowDelta, 4));
+
+	Mask = uint32(_mm_cvtsi128_si32(Rows)) | (ReadRow(Bytes, Base + RowDelta[8]) << 24);
+#else
+	Mask = 0;
+	for (int32 Row = 0; Row < 9; ++Row)
+	{
+		Mask |= ReadRow(Bytes, Base + RowDelta[Row]) << (Row * 3);
+	}
+#endif
+
+	// Z borders read padding, X and Y borders would wrap into the next row or layer
+	if (X == 0 || X == GridX - 1 || Y == 0 || Y == GridY - 1)
+	{
+		Mask &= ~ClipMask(X == 0, X == GridX - 1, Y == 0, Y == GridY - 1, false, false);
+	}
+
+	return Mask;
+}
+
+int32 FMGDNWalkableBits::CountWalkable() const
+{
+	int32 Count = 0;
+	for (const uint64 Word : Words)
+	{
+		Count += FMath::CountBits(Word);
+	}
+	return Count;
+}
+
+void FMGDNWalkableBits::BuildRanks()
+{
+	WordRanks.SetNumUninitialized(Words.Num());
+
+	int32 Count = 0;
+	for (int32 i = 0; i < Words.Num(); ++i)
+	{
+		WordRanks[i] = Count;
+		Count += FMath::CountBits(Words[i]);
+	}
+}
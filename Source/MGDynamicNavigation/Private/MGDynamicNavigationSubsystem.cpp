@@ -14,9 +14,20 @@
 
 void UMGDynamicNavigationSubsystem::Tick(float DeltaTime)
 {
+    UpdateObstacles();
+    ProcessPathRequests();
     TickMGDN(DeltaTime);
 }
 
+void UMGDynamicNavigationSubsystem::Deinitialize()
+{
+    // Workers may still read nav data owned by volumes that go away with the world
+    WaitForPathRequests();
+    PendingPaths.Reset();
+
+    Super::Deinitialize();
+}
+
 void UMGDynamicNavigationSubsystem::RegisterVolume(UMGDNNavVolumeComponent* Volume)
 {
     if (!Volume) return;
@@ -54,6 +65,104 @@ void UMGDynamicNavigationSubsystem::DeregisterVolume(UMGDNNavVolumeComponent* Vo
     }
 }
 
+bool UMGDynamicNavigationSubsystem::RegisterObstacle(AActor* Actor)
+{
+    if (!Actor)
+        return false;
+
+    for (const FMGDNObstacleActor& O : ObstacleActors)
+    {
+        if (O.Actor == Actor)
+            return true;
+    }
+
+    const FVector Location = Actor->GetActorLocation();
+
+    for (const FMGDNInstance& I : Instances)
+    {
+        if (!I.VolumeComp || !I.VolumeComp->SourceAsset || !I.VolumeComp->GetOwner())
+            continue;
+
+        const FVector L = I.VolumeComp->GetOwner()->GetActorTransform().InverseTransformPosition(Location);
+        const FVector HSCheck = I.VolumeComp->SourceAsset->HalfSize;
+
+        if (FMath::Abs(L.X) > HSCheck.X || FMath::Abs(L.Y) > HSCheck.Y || FMath::Abs(L.Z) > HSCheck.Z)
+            continue;
+
+        FMGDNObstacleActor& O = ObstacleActors.AddDefaulted_GetRef();
+        O.Actor = Actor;
+        O.Volume = I.VolumeComp;
+
+        // Placed by the first UpdateObstacles
+        O.LastRelative.SetScale3D(FVector::ZeroVector);
+        UpdateObstacles();
+        return true;
+    }
+
+    UE_LOG(LogTemp, Warning, TEXT("[MGDN] RegisterObstacle: %s is not inside any nav volume"), *Actor->GetName());
+    return false;
+}
+
+void UMGDynamicNavigationSubsystem::UnregisterObstacle(AActor* Actor)
+{
+    for (int32 i = ObstacleActors.Num() - 1; i >= 0; i--)
+    {
+        const FMGDNObstacleActor& O = ObstacleActors[i];
+        if (O.Actor != Actor)
+            continue;
+
+        if (O.Volume && O.ObstacleId != INDEX_NONE)
+            O.Volume->RemoveObstacle(O.ObstacleId);
+
+        ObstacleActors.RemoveAt(i);
+    }
+}
+
+void UMGDynamicNavigationSubsystem::UpdateObstacles()
+{
+    for (int32 i = ObstacleActors.Num() - 1; i >= 0; i--)
+    {
+        FMGDNObstacleActor& O = ObstacleActors[i];
+        AActor* Actor = O.Actor.Get();
+        AActor* Platform = O.Volume ? O.Volume->GetOwner() : nullptr;
+
+        if (!Actor || !Platform)
+        {
+            if (O.Volume && O.ObstacleId != INDEX_NONE)
+                O.Volume->RemoveObstacle(O.ObstacleId);
+
+            ObstacleActors.RemoveAt(i);
+            continue;
+        }
+
+        // Containers riding the platform keep their relative transform, only sliding ones restamp
+        const FTransform Relative = Actor->GetActorTransform().GetRelativeTransform(Platform->GetActorTransform());
+        if (Relative.Equals(O.LastRelative, 0.5f))
+            continue;
+
+        O.LastRelative = Relative;
+
+        const FBox Bounds = Actor->CalculateComponentsBoundingBoxInLocalSpace();
+        if (!Bounds.IsValid)
+            continue;
+
+        const FTransform Box(Relative.GetRotation(), Relative.TransformPosition(Bounds.GetCenter()));
+        const FVector Extent = Bounds.GetExtent() * Relative.GetScale3D().GetAbs();
+
+        if (O.ObstacleId == INDEX_NONE)
+            O.ObstacleId = O.Volume->AddObstacle(Box, Extent);
+        else
+            O.Volume->MoveObstacle(O.ObstacleId, Box, Extent);
+    }
+
+    // Changes queued behind worker searches that have finished since
+    for (const FMGDNInstance& I : Instances)
+    {
+        if (I.VolumeComp)
+            I.VolumeComp->ApplyQueuedObstacles();
+    }
+}
+
 void UMGDynamicNavigationSubsystem::TickMGDN(float DeltaTime)
 {
     for (int32 i = ActiveMoves.Num() - 1; i >= 0; i--)
@@ -71,6 +180,83 @@ void UMGDynamicNavigationSubsystem::TickMGDN(float DeltaTime)
         auto CurrentColProfile = Capsule->GetCollisionProfileName();
 
         const FTransform PlatformTransform = M.Platform->GetActorTransform();
+
+        // Restores the pawn, drops the move and reports Result, M is gone afterwards
+        auto EndMove = [&](EMGDNMoveResult Result)
+        {
+            Capsule->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+            Capsule->SetCollisionProfileName(CurrentColProfile);
+
+            USplineComponent* S = M.Spline;
+            M.Spline = nullptr;
+            if (S) S->DestroyComponent();
+
+            auto CB = M.Callback;
+            ActiveMoves.RemoveAt(i);
+            CB.ExecuteIfBound(Result);
+
+            if (UMovementComponent* MoveComp = Pawn->GetMovementComponent())
+            {
+                MoveComp->Velocity = FVector::ZeroVector;
+            }
+        };
+
+        // ---------------------------------------------------------------------
+        // 0. Replan when cells along the rest of the path were blocked or reopened
+        // ---------------------------------------------------------------------
+        if (!M.bDirectMove && M.RuntimeNav && M.RuntimeNav->GetNavVersion() != M.NavVersion)
+        {
+            const FVector PawnLocal = PlatformTransform.InverseTransformPosition(Pawn->GetActorLocation());
+
+            if (!IsPathNearChangedCells(M, PawnLocal, Capsule->GetScaledCapsuleRadius()))
+            {
+                // Changes elsewhere on the grid, nothing to repair
+                M.NavVersion = M.RuntimeNav->GetNavVersion();
+            }
+            else if (!ReplanChangedPath(M, Pawn, Capsule, PlatformTransform))
+            {
+                EndMove(EMGDNMoveResult::Failed_NoPath);
+                continue;
+            }
+        }
+
+        // ---------------------------------------------------------------------
+        // 0. Follow target, replan once it left the cell the path ends in
+        // ---------------------------------------------------------------------
+        if (M.bFollowTarget)
+        {
+            const AActor* Target = M.FollowTarget.Get();
+            if (!Target)
+            {
+                EndMove(EMGDNMoveResult::Failed_TargetLost);
+                continue;
+            }
+
+            const FVector PawnLocal   = PlatformTransform.InverseTransformPosition(Pawn->GetActorLocation());
+            const FVector TargetLocal = PlatformTransform.InverseTransformPosition(Target->GetActorLocation());
+
+            // Caught up, on the same deck
+            if (FVector::Dist2D(PawnLocal, TargetLocal) <= M.AcceptanceRadius &&
+                FMath::Abs(PawnLocal.Z - TargetLocal.Z) <= Capsule->GetScaledCapsuleHalfHeight() * 2.f)
+            {
+                EndMove(EMGDNMoveResult::Success);
+                continue;
+            }
+
+            M.FollowCooldown -= DeltaTime;
+            if (M.FollowCooldown <= 0.f && M.RuntimeNav)
+            {
+                M.FollowCooldown = FollowReplanInterval;
+
+                const float HalfCell = 0.5f * M.RuntimeNav->CellSize;
+                if (FVector::DistSquared(TargetLocal, M.LocalGoal) > FMath::Square(HalfCell) &&
+                    !ReplanChangedPath(M, Pawn, Capsule, PlatformTransform))
+                {
+                    EndMove(EMGDNMoveResult::Failed_NoPath);
+                    continue;
+                }
+            }
+        }
         
         // ---------------------------------------------------------------------
         // 0. Avoidance .. @Todo Freeze and Unfreeze pawn functions and refactor tick, freeze logic.
@@ -185,25 +371,61 @@ void UMGDynamicNavigationSubsystem::TickMGDN(float DeltaTime)
         // ---------------------------------------------------------------------
         if (M.SplineDistance >= EndDist - M.AcceptanceRadius)
         {
-            Capsule->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-            Capsule->SetCollisionProfileName(CurrentColProfile);
-
-            USplineComponent* S = M.Spline;
-            M.Spline = nullptr;
-            if (S) S->DestroyComponent();
-
-            auto CB = M.Callback;
-            ActiveMoves.RemoveAt(i);
-            CB.ExecuteIfBound(EMGDNMoveResult::Success);
-
-            if (UMovementComponent* MoveComp = Pawn->GetMovementComponent())
+            // Followers wait at the end of their path until the target is caught or moves on
+            if (M.bFollowTarget)
             {
-                MoveComp->Velocity = FVector::ZeroVector;
+                M.SplineDistance = FMath::Min(M.SplineDistance, EndDist);
+            }
+            else
+            {
+                EndMove(EMGDNMoveResult::Success);
             }
         }
     }
 }
 
+// True when LocalPath matches the last spline points, none of which the pawn at Distance has passed yet
+static bool IsSplineAhead(const USplineComponent* Spline, const TArray<FVector>& LocalPath, float Distance)
+{
+    const int32 First = Spline->GetNumberOfSplinePoints() - LocalPath.Num();
+    if (LocalPath.Num() == 0 || First < 1 || Spline->GetDistanceAlongSplineAtSplinePoint(First) < Distance)
+        return false;
+
+    // Spline points sit on the traced surface, only XY comes from the path
+    for (int32 i = 0; i < LocalPath.Num(); ++i)
+    {
+        const FVector P = Spline->GetLocationAtSplinePoint(First + i, ESplineCoordinateSpace::Local);
+        if (FVector::DistSquared2D(P, LocalPath[i]) > 1.f)
+            return false;
+    }
+
+    return true;
+}
+
+static UMGDNNavDataAsset* GetPlatformAsset(AActor* Platform)
+{
+    UMGDNNavVolumeComponent* Vol = Cast<UMGDNNavVolumeComponent>(
+        Platform->GetComponentByClass(UMGDNNavVolumeComponent::StaticClass()));
+    return (Vol ? Vol->SourceAsset : nullptr);
+}
+
+// Keeps a spline point SafeRadius inside the platform and puts it on the traced surface
+static FVector ToSplinePoint(const UMGDNNavDataAsset* Asset, AActor* Platform, FVector P, float SafeRadius)
+{
+    const FVector HS = Asset->HalfSize;
+
+    P.X = FMath::Clamp(P.X, -HS.X + SafeRadius, HS.X - SafeRadius);
+    P.Y = FMath::Clamp(P.Y, -HS.Y + SafeRadius, HS.Y - SafeRadius);
+
+    P.Z = UMGDynamicNavigationSubsystem::GetTrueSurfaceZ_Local(
+            Asset,
+            Platform->GetActorTransform(),
+            P,
+            Platform->GetWorld());
+
+    return P;
+}
+
 static USplineComponent* CreateSplinePath(
     AActor* Platform,
     const FVector& PawnLocal,
@@ -217,28 +439,9 @@ static USplineComponent* CreateSplinePath(
 
     Spline->ClearSplinePoints(false);
 
-    UMGDNNavVolumeComponent* Vol = Cast<UMGDNNavVolumeComponent>(
-        Platform->GetComponentByClass(UMGDNNavVolumeComponent::StaticClass()));
-    UMGDNNavDataAsset* Asset = (Vol ? Vol->SourceAsset : nullptr);
-
-    FVector StartLocal = PawnLocal;
-
-    if (Asset)
-    {
-        const FVector HS = Asset->HalfSize;
-
-        StartLocal.X = FMath::Clamp(StartLocal.X, -HS.X + SafeRadius, HS.X - SafeRadius);
-        StartLocal.Y = FMath::Clamp(StartLocal.Y, -HS.Y + SafeRadius, HS.Y - SafeRadius);
-
-        float Z =
-            UMGDynamicNavigationSubsystem::GetTrueSurfaceZ_Local(
-                Asset,
-                Platform->GetActorTransform(),
-                StartLocal,
-                Platform->GetWorld());
+    const UMGDNNavDataAsset* Asset = GetPlatformAsset(Platform);
 
-        StartLocal.Z = Z;
-    }
+    const FVector StartLocal = Asset ? ToSplinePoint(Asset, Platform, PawnLocal, SafeRadius) : PawnLocal;
 
     Spline->AddPoint(FSplinePoint(0, StartLocal, ESplinePointType::Linear));
 
@@ -247,16 +450,7 @@ static USplineComponent* CreateSplinePath(
     {
         if (Asset)
         {
-            const FVector HS = Asset->HalfSize;
-
-            P.X = FMath::Clamp(P.X, -HS.X + SafeRadius, HS.X - SafeRadius);
-            P.Y = FMath::Clamp(P.Y, -HS.Y + SafeRadius, HS.Y - SafeRadius);
-
-            P.Z = UMGDynamicNavigationSubsystem::GetTrueSurfaceZ_Local(
-                    Asset,
-                    Platform->GetActorTransform(),
-                    P,
-                    Platform->GetWorld());
+            P = ToSplinePoint(Asset, Platform, P, SafeRadius);
         }
         else
         {
@@ -443,25 +637,232 @@ bool UMGDynamicNavigationSubsystem::InsertAvoidanceDetour(
 
     FVector AvoidWorldRecalc = PlatformTransform.TransformPosition(AvoidLocal);
 
-    FVector GoalLocal = M.LocalGoal;
-    GoalLocal.Z = PawnLocal.Z;
+    FMGDNPathQuery Query = M.Query;
+    Query.AgentRadius = FMath::Max(Query.AgentRadius, Rad);
+
+    const UMGDNRuntimeNavMesh* AgentNav = Inst->VolumeComp
+        ? Inst->VolumeComp->GetRuntimeNavFor(Rad, Capsule->GetScaledCapsuleHalfHeight() * 2.f)
+        : Inst->RuntimeNav;
+
+    // Rejoin the current path a window ahead, stepping around a pawn never needs the whole route searched again.
+    // Moves on a flow field replan by following it to the goal, no search.
+    const float RejoinDist = M.SplineDistance + FMath::Max(DetourWindowCells, 1) * AgentNav->CellSize;
+    const bool bRejoinAtGoal = M.FlowField || RejoinDist >= M.Spline->GetSplineLength();
 
-    if (GoalLocal.X < -HSCheck.X || GoalLocal.X > HSCheck.X ||
-        GoalLocal.Y < -HSCheck.Y || GoalLocal.Y > HSCheck.Y)
+    // Keeps its own height, the rejoin point may lie up a ramp or on another deck than the pawn
+    const FVector RejoinLocal = bRejoinAtGoal
+        ? M.LocalGoal
+        : M.Spline->GetLocationAtDistanceAlongSpline(RejoinDist, ESplineCoordinateSpace::Local);
+
+    if (RejoinLocal.X < -HSCheck.X || RejoinLocal.X > HSCheck.X ||
+        RejoinLocal.Y < -HSCheck.Y || RejoinLocal.Y > HSCheck.Y)
     {
         return false;
     }
 
-    FVector GoalWorld = PlatformTransform.TransformPosition(GoalLocal);
+    const FVector RejoinWorld = PlatformTransform.TransformPosition(RejoinLocal);
 
-    if (!Inst->RuntimeNav->FindPath(
-        PlatformTransform,
-        AvoidWorldRecalc,
-        GoalWorld,
-        NewWorldPath))
+    // A failed detour waits the blocker out like a taken one, searching again every tick would not find more
+    if (M.FlowField)
     {
-        return false;
+        if (!AgentNav->FindFlowPath(PlatformTransform, AvoidWorldRecalc, RejoinWorld, NewWorldPath, M.FlowField, Query))
+        {
+            M.AvoidanceCooldown = 1.f;
+            return false;
+        }
+    }
+    else
+    {
+        int32 StartIndex, RejoinIndex;
+        if (!AgentNav->ResolvePathCells(PlatformTransform, AvoidWorldRecalc, RejoinWorld, StartIndex, RejoinIndex))
+        {
+            M.AvoidanceCooldown = 1.f;
+            return false;
+        }
+
+        // A window the blocker closed off runs out of expansions instead of searching around the whole platform
+        FMGDNSlicedSearch Window;
+        AgentNav->BeginSlicedSearch(StartIndex, RejoinIndex, Window, Query);
+
+        if (!AgentNav->StepSlicedSearch(Window, FMath::Max(DetourMaxExpansions, 1)) || !Window.bFound)
+        {
+            M.AvoidanceCooldown = 1.f;
+            return false;
+        }
+
+        UE_LOG(LogTemp, Verbose, TEXT("[MGDN] InsertAvoidanceDetour: %s Cells=%d Expansions=%d"),
+            *Pawn->GetName(), Window.Path.Num(), Window.Stats.Expansions);
+
+        if (Query.bSmoothPath)
+        {
+            AgentNav->SmoothIndexPath(Window.Path, Query);
+        }
+
+        AgentNav->IndexPathToWorld(PlatformTransform, Window.Path, NewWorldPath);
+    }
+
+    // Only the window changes, drop the points before the rejoin point and keep the traced rest of the spline
+    USplineComponent* Spline = M.Spline;
+    int32 Rejoin = Spline->GetNumberOfSplinePoints();
+    if (!bRejoinAtGoal)
+    {
+        for (int32 Point = 0; Point < Spline->GetNumberOfSplinePoints(); ++Point)
+        {
+            if (Spline->GetDistanceAlongSplineAtSplinePoint(Point) > RejoinDist)
+            {
+                Rejoin = Point;
+                break;
+            }
+        }
+    }
+
+    for (int32 Point = Rejoin - 1; Point >= 0; --Point)
+    {
+        Spline->RemoveSplinePoint(Point, false);
+    }
+
+    const UMGDNNavDataAsset* Asset = GetPlatformAsset(Platform);
+    const float SafeRadius = Rad * 0.25f;
+
+    TArray<FVector> WindowLocal;
+    WindowLocal.Reserve(2 + NewWorldPath.Num());
+    WindowLocal.Add(PawnLocal);
+    WindowLocal.Add(AvoidLocal);
+    for (const FVector& WP : NewWorldPath)
+    {
+        WindowLocal.Add(PlatformTransform.InverseTransformPosition(WP));
+    }
+
+    for (int32 Point = 0; Point < WindowLocal.Num(); ++Point)
+    {
+        FVector P = WindowLocal[Point];
+        if (Asset)
+        {
+            P = ToSplinePoint(Asset, Platform, P, SafeRadius);
+        }
+        else
+        {
+            P.Z = PawnLocal.Z;
+        }
+
+        Spline->AddSplinePointAtIndex(P, Point, ESplineCoordinateSpace::Local, false);
+        Spline->SetSplinePointType(Point, ESplinePointType::Linear, false);
+    }
+
+    Spline->UpdateSpline();
+
+    M.SplineDistance = 0.f;
+
+    M.AvoidanceCooldown = 1.f;
+    return true;
+}
+
+bool UMGDynamicNavigationSubsystem::ReplanChangedPath(
+    FMGDNActiveMove& M,
+    APawn* Pawn,
+    UCapsuleComponent* Capsule,
+    const FTransform& PlatformTransform)
+{
+    const UMGDNRuntimeNavMesh* Nav = M.RuntimeNav;
+    M.NavVersion = Nav->GetNavVersion();
+
+    if (M.bFollowTarget)
+    {
+        // Chase the target where it stands now, a field of its old cell is no use
+        if (const AActor* Target = M.FollowTarget.Get())
+        {
+            M.Goal = Target->GetActorLocation();
+            M.LocalGoal = PlatformTransform.InverseTransformPosition(M.Goal);
+        }
+        M.FlowField.Reset();
+    }
+
+    const float Rad = Capsule->GetScaledCapsuleRadius();
+
+    FMGDNPathQuery Query = M.Query;
+    Query.AgentRadius = FMath::Max(Query.AgentRadius, Rad);
+
+    const FVector PawnPos = Pawn->GetActorLocation();
+    const FVector GoalWorld = PlatformTransform.TransformPosition(M.LocalGoal);
+
+    TArray<FVector> NewWorldPath;
+
+    if (M.FlowField)
+    {
+        // The changed grid gets a new field, shared again by every move to the goal
+        if (!Nav->FindFlowPath(PlatformTransform, PawnPos, GoalWorld, NewWorldPath, M.FlowField, Query))
+            return false;
     }
+    else
+    {
+        int32 StartIndex, GoalIndex;
+        if (!Nav->ResolvePathCells(PlatformTransform, PawnPos, GoalWorld, StartIndex, GoalIndex))
+            return false;
+
+        bool bFound = false;
+        TArray<int32> IndexPath;
+        FMGDNSearchStats Stats;
+
+        if (!Nav->HasDefaultMoves(Query))
+        {
+            // D* Lite repairs every move at its length only, other moves and cell costs search again
+            M.Replanner.Reset();
+            bFound = Nav->FindIndexPath(StartIndex, GoalIndex, IndexPath, Query, &Stats);
+        }
+        else if (M.bFollowTarget)
+        {
+            // Rooted at the pawn, the target moving and the pawn walking its path both keep most of the search
+            if (!M.Replanner)
+                M.Replanner = MakeShared<FMGDNIncrementalPath>();
+
+            bFound = Nav->FollowIncrementalPath(*M.Replanner, StartIndex, GoalIndex, Query.AgentRadius);
+        }
+        else if (M.Replanner && M.Replanner->Goal == GoalIndex)
+        {
+            bFound = Nav->ReplanIncrementalPath(*M.Replanner, StartIndex);
+        }
+        else
+        {
+            // First change on this move or its goal cell was blocked, search once and repair from then on
+            if (!M.Replanner)
+                M.Replanner = MakeShared<FMGDNIncrementalPath>();
+
+            bFound = Nav->BeginIncrementalPath(StartIndex, GoalIndex, *M.Replanner, Query.AgentRadius);
+        }
+
+        if (!bFound)
+            return false;
+
+        if (M.Replanner)
+        {
+            IndexPath = M.Replanner->Path;
+            Stats = M.Replanner->Stats;
+        }
+
+        UE_LOG(LogTemp, Verbose, TEXT("[MGDN] ReplanChangedPath: %s Cells=%d Expansions=%d"),
+            *Pawn->GetName(), IndexPath.Num(), Stats.Expansions);
+
+        if (Query.bSmoothPath)
+        {
+            Nav->SmoothIndexPath(IndexPath, Query);
+        }
+
+        Nav->IndexPathToWorld(PlatformTransform, IndexPath, NewWorldPath);
+
+        // End on the target rather than the centre of its cell
+        if (M.bFollowTarget && NewWorldPath.Num() > 1)
+        {
+            NewWorldPath.Last() = GoalWorld;
+        }
+    }
+
+    // The pawn already stands in the start cell, walking back to its centre would only stall it
+    if (NewWorldPath.Num() > 1)
+    {
+        NewWorldPath.RemoveAt(0);
+    }
+
+    const FVector PawnLocal = PlatformTransform.InverseTransformPosition(PawnPos);
 
     TArray<FVector> NewLocal;
     NewLocal.Reserve(NewWorldPath.Num());
@@ -473,32 +874,65 @@ bool UMGDynamicNavigationSubsystem::InsertAvoidanceDetour(
         NewLocal.Add(P);
     }
 
-    TArray<FVector> FinalLocal;
-    FinalLocal.Reserve(1 + NewLocal.Num());
-    FinalLocal.Add(AvoidLocal);
-    for (const FVector& P : NewLocal)
-    {
-        FinalLocal.Add(P);
-    }
+    // The repair kept the waypoints ahead, the spline and the pawn's place on it stay as they are
+    if (M.Spline && IsSplineAhead(M.Spline, NewLocal, M.SplineDistance))
+        return true;
 
     USplineComponent* OldSpline = M.Spline;
-    USplineComponent* NewSpline = CreateSplinePath(
-        Platform,
-        PawnLocal,
-        FinalLocal,
-        Rad * 0.25f
-    );
-
-    M.Spline = NewSpline;
+    M.Spline = CreateSplinePath(M.Platform, PawnLocal, NewLocal, Rad * 1.25f);
     if (OldSpline)
         OldSpline->DestroyComponent();
 
     M.SplineDistance = 0.f;
-
-    M.AvoidanceCooldown = 1.f;
     return true;
 }
 
+bool UMGDynamicNavigationSubsystem::IsPathNearChangedCells(const FMGDNActiveMove& M, const FVector& PawnLocal, float AgentRadius)
+{
+    const UMGDNRuntimeNavMesh* Nav = M.RuntimeNav;
+
+    // The log no longer reaches back to the last check or the grid was rebuilt, anything may have changed
+    TArray<int32> Changed;
+    if (!Nav->GetCellChangesSince(M.NavVersion, Changed))
+        return true;
+
+    if (Changed.Num() == 0 || !M.Spline)
+        return Changed.Num() > 0;
+
+    // Segments still ahead, starting at the pawn
+    TArray<FVector> Ahead;
+    Ahead.Add(PawnLocal);
+
+    for (int32 Point = 0; Point < M.Spline->GetNumberOfSplinePoints(); ++Point)
+    {
+        if (M.Spline->GetDistanceAlongSplineAtSplinePoint(Point) > M.SplineDistance)
+            Ahead.Add(M.Spline->GetLocationAtSplinePoint(Point, ESplineCoordinateSpace::Local));
+    }
+
+    // A cell touches the path when any part of it is within the agent's radius of a segment on the same deck
+    const float Reach = AgentRadius + Nav->CellSize * UE_HALF_SQRT_2;
+
+    for (const int32 Cell : Changed)
+    {
+        const FVector Centre = Nav->GetCellCenterLocal(Cell);
+
+        for (int32 i = 0; i + 1 < Ahead.Num(); ++i)
+        {
+            const FVector& A = Ahead[i];
+            const FVector& B = Ahead[i + 1];
+
+            if (Centre.Z < FMath::Min(A.Z, B.Z) - Nav->CellHeight || Centre.Z > FMath::Max(A.Z, B.Z) + Nav->CellHeight)
+                continue;
+
+            const FVector Flat(Centre.X, Centre.Y, 0.f);
+            if (FMath::PointDistToSegment(Flat, FVector(A.X, A.Y, 0.f), FVector(B.X, B.Y, 0.f)) <= Reach)
+                return true;
+        }
+    }
+
+    return false;
+}
+
 // This returns Z height local
 float UMGDynamicNavigationSubsystem::GetSurfaceZ_Local(
     const UMGDNNavDataAsset* Asset,
@@ -508,15 +942,17 @@ float UMGDynamicNavigationSubsystem::GetSurfaceZ_Local(
 
     const FVector HS = Asset->HalfSize;
 
-    int32 GX = FMath::Clamp(int32((Local.X + HS.X) / Asset->CellSize),   0, Asset->GridX - 1);
-    int32 GY = FMath::Clamp(int32((Local.Y + HS.Y) / Asset->CellSize),   0, Asset->GridY - 1);
-    int32 GZ = FMath::Clamp(int32((Local.Z + HS.Z) / Asset->CellHeight), 0, Asset->GridZ - 1);
+    const FIntVector& Offset = Asset->CellOffset;
+
+    int32 GX = FMath::Clamp(int32((Local.X + HS.X) / Asset->CellSize)   - Offset.X, 0, Asset->GridX - 1);
+    int32 GY = FMath::Clamp(int32((Local.Y + HS.Y) / Asset->CellSize)   - Offset.Y, 0, Asset->GridY - 1);
+    int32 GZ = FMath::Clamp(int32((Local.Z + HS.Z) / Asset->CellHeight) - Offset.Z, 0, Asset->GridZ - 1);
 
-    int32 Id = Asset->Index(GX, GY, GZ);
-    if (!Asset->Nodes.IsValidIndex(Id))
+    const FMGDNGridNode* Node = Asset->FindNode(GX, GY, GZ);
+    if (!Node)
         return Local.Z;
 
-    return Asset->Nodes[Id].Height;
+    return Node->Height;
 }
 
 // This returns the point from data
@@ -633,72 +1069,356 @@ void UMGDynamicNavigationSubsystem::MoveToLocationMGDNAsync(
         return;
     }
 
-    // Get capsule sizes and make a fallback if no capsule which is an edge case
-    float CapsuleR = 40.f;
-    float CapsuleH = 88.f;
+    // Paths only pass where the capsule fits, not just its centre, on the grid baked for its size
+    FMGDNPathQuery Query = PathQuery;
+    UMGDNRuntimeNavMesh* AgentNav = Inst->RuntimeNav;
 
-    if (UCapsuleComponent* Capsule = Cast<UCapsuleComponent>(Pawn->GetRootComponent()))
+    if (const UCapsuleComponent* Capsule = Cast<UCapsuleComponent>(Pawn->GetRootComponent()))
     {
-        CapsuleR = Capsule->GetScaledCapsuleRadius();
-        CapsuleH = Capsule->GetScaledCapsuleHalfHeight();
+        Query.AgentRadius = FMath::Max(Query.AgentRadius, Capsule->GetScaledCapsuleRadius());
+
+        if (Inst->VolumeComp)
+        {
+            AgentNav = Inst->VolumeComp->GetRuntimeNavFor(
+                Capsule->GetScaledCapsuleRadius(), Capsule->GetScaledCapsuleHalfHeight() * 2.f);
+        }
     }
 
-    // A bit increase the radius
-    const float SafeX = CapsuleR * 1.25f;
-    const float SafeY = CapsuleR * 1.25f;
+    FMGDNPathRequest& Request = PendingPaths.AddDefaulted_GetRef();
+    Request.Controller = Controller;
+    Request.Platform = Platform;
+    Request.RuntimeNav = AgentNav;
+    Request.Goal = Goal;
+    Request.AcceptanceRadius = AcceptanceRadius;
+    Request.MoveSpeed = MoveSpeed;
+    Request.Callback = Callback;
+    Request.PlatformTransform = Platform->GetActorTransform();
+    Request.Query = Query;
+    Request.Start = PawnLoc;
+
+    LaunchPathRequest(Request);
+}
+
+void UMGDynamicNavigationSubsystem::LaunchPathRequest(FMGDNPathRequest& Request)
+{
+    const bool bOnWorker = bUseFlowFields || SearchExpansionsPerFrame <= 0;
+
+    // Queued obstacle changes wait for worker searches on the grid, so new ones wait for the changes in turn
+    const UMGDNNavVolumeComponent* Vol = Request.Platform
+        ? Request.Platform->FindComponentByClass<UMGDNNavVolumeComponent>()
+        : nullptr;
+
+    Request.bHeld = bOnWorker && Vol && Vol->HasQueuedObstacles();
+    if (Request.bHeld)
+        return;
 
-    const FTransform T = Platform->GetActorTransform();
-    FVector PawnLocal = T.InverseTransformPosition(PawnLoc);
-    FVector EndLocal  = T.InverseTransformPosition(Goal);
+    // The worker only reads nav data, rebuilds wait for it through WaitForPathRequests
+    const UMGDNRuntimeNavMesh* Nav = Request.RuntimeNav;
+    const FTransform T = Request.PlatformTransform;
+    const FVector PawnLoc = Request.Start;
+    const FVector Goal = Request.Goal;
+    const FMGDNPathQuery Query = Request.Query;
 
-    // Cache HalfSize 
-    const FVector HS = Inst->VolumeComp->SourceAsset->HalfSize;
+    Request.NavVersion = Nav->GetNavVersion();
 
-    TArray<FVector> WorldPath;
-    if (!Inst->RuntimeNav->FindPath(T, PawnLoc, Goal, WorldPath))
+    if (bUseFlowFields)
     {
-        Callback.ExecuteIfBound(EMGDNMoveResult::Failed_NoPath);
+        // Concurrent requests to one goal wait for the first one's field inside GetFlowField, then share it
+        Request.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Nav, T, PawnLoc, Goal, Query]()
+        {
+            FMGDNPathTaskResult Result;
+            Result.bFound = Nav->FindFlowPath(T, PawnLoc, Goal, Result.WorldPath, Result.FlowField, Query);
+            return Result;
+        });
         return;
     }
 
-    TArray<FVector> LocalPath;
-    LocalPath.Reserve(WorldPath.Num());
-    for (const FVector& W : WorldPath)
+    if (SearchExpansionsPerFrame > 0)
     {
-        FVector P = T.InverseTransformPosition(W);
-
-        // Keep Z 
-        P.Z = PawnLocal.Z;
+        // Cells are resolved now, the search itself advances a slice per tick in StepSlicedPathRequests
+        Request.Sliced = MakeShared<FMGDNSlicedSearch>();
 
-        // Clamp path so spline not in edges
-        P.X = FMath::Clamp(P.X, -HS.X + SafeX, HS.X - SafeX);
-        P.Y = FMath::Clamp(P.Y, -HS.Y + SafeY, HS.Y - SafeY);
+        int32 StartIndex, EndIndex;
+        if (!Nav->ResolvePathCells(T, PawnLoc, Goal, StartIndex, EndIndex))
+        {
+            Request.Sliced->bDone = true;
+            return;
+        }
 
-        LocalPath.Add(P);
+        Nav->BeginSlicedSearch(StartIndex, EndIndex, *Request.Sliced, Query);
+        return;
     }
 
-    USplineComponent* Spline =
-        CreateSplinePath(Platform, PawnLocal, LocalPath, SafeX);
+    Request.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Nav, T, PawnLoc, Goal, Query]()
+    {
+        FMGDNPathTaskResult Result;
+        Result.bFound = Nav->FindPath(T, PawnLoc, Goal, Result.WorldPath, Query);
+        return Result;
+    });
+}
 
-    if (!Spline)
+void UMGDynamicNavigationSubsystem::MoveToActorMGDNAsync(
+    AAIController* Controller,
+    AActor* Target,
+    float AcceptanceRadius,
+    float MoveSpeed,
+    FMGDNMoveFinishedDynamicDelegate Callback)
+{
+    if (!Target)
     {
-        Callback.ExecuteIfBound(EMGDNMoveResult::Failed_MoveRequest);
+        Callback.ExecuteIfBound(EMGDNMoveResult::Failed_TargetLost);
         return;
     }
 
-    FMGDNActiveMove Move;
-    Move.Controller = Controller;
-    Move.Platform = Platform;
-    Move.Goal = Goal;
-    Move.LocalGoal = EndLocal;
-    Move.Spline = Spline;
+    const int32 NumPending = PendingPaths.Num();
+    MoveToLocationMGDNAsync(Controller, Target->GetActorLocation(), AcceptanceRadius, MoveSpeed, Callback);
 
-    Move.MoveSpeed = MoveSpeed;
-    Move.SplineDistance = 0.f;
-    Move.AcceptanceRadius = AcceptanceRadius;
-    Move.Callback = Callback;
+    // No request when the controller or platform checks failed, the callback already ran then
+    if (PendingPaths.Num() > NumPending)
+    {
+        PendingPaths.Last().FollowTarget = Target;
+    }
+}
 
-    ActiveMoves.Add(Move);
+void UMGDynamicNavigationSubsystem::StepSlicedPathRequests()
+{
+    // Searches left over after the budget was switched off still finish
+    int32 Budget = SearchExpansionsPerFrame > 0 ? SearchExpansionsPerFrame : MAX_int32;
+
+    // Smallest share per search, so a long queue still makes progress without tiny slices
+    const int32 MinSlice = 64;
+
+    const int32 MaxRunning = FMath::Max(MaxSlicedSearches, 1);
+
+    while (Budget > 0)
+    {
+        int32 Running = 0;
+        for (const FMGDNPathRequest& Request : PendingPaths)
+        {
+            if (Request.Sliced && !Request.Sliced->bDone)
+                Running++;
+        }
+
+        if (Running == 0)
+            break;
+
+        Running = FMath::Min(Running, MaxRunning);
+
+        // Equal shares, whatever finished searches leave over goes around again
+        const int32 Slice = FMath::Max(Budget / Running, MinSlice);
+        int32 Stepped = 0;
+
+        for (FMGDNPathRequest& Request : PendingPaths)
+        {
+            if (!Request.Sliced || Request.Sliced->bDone)
+                continue;
+
+            // Requests are queued oldest first, the first MaxRunning unfinished ones are the ones holding records
+            if (++Stepped > MaxRunning)
+                break;
+
+            if (!Request.RuntimeNav)
+            {
+                Request.Sliced->bDone = true;
+                continue;
+            }
+
+            const int32 Before = Request.Sliced->Stats.Expansions;
+            Request.RuntimeNav->StepSlicedSearch(*Request.Sliced, FMath::Min(Slice, Budget));
+            Budget -= Request.Sliced->Stats.Expansions - Before;
+
+            if (Budget <= 0)
+                break;
+        }
+    }
+}
+
+void UMGDynamicNavigationSubsystem::ProcessPathRequests()
+{
+    // Held requests start once UpdateObstacles applied their volume's queued changes
+    for (FMGDNPathRequest& Request : PendingPaths)
+    {
+        if (Request.bHeld)
+        {
+            LaunchPathRequest(Request);
+        }
+    }
+
+    StepSlicedPathRequests();
+
+    int32 Processed = 0;
+
+    for (int32 i = 0; i < PendingPaths.Num() && Processed < MaxPathResultsPerTick; )
+    {
+        const FMGDNPathRequest& Pending = PendingPaths[i];
+        const bool bReady = !Pending.bHeld && (Pending.Sliced ? Pending.Sliced->bDone : Pending.Task.IsCompleted());
+
+        if (!bReady)
+        {
+            i++;
+            continue;
+        }
+
+        // Oldest first, so a burst of requests starts moving in the order it was issued
+        FMGDNPathRequest Request = MoveTemp(PendingPaths[i]);
+        PendingPaths.RemoveAt(i, 1, EAllowShrinking::No);
+        Processed++;
+
+        FMGDNPathTaskResult Result;
+        if (Request.Sliced)
+        {
+            ResolveSlicedPathRequest(Request);
+            Result = MoveTemp(Request.SlicedResult);
+        }
+        else
+        {
+            Result = MoveTemp(Request.Task.GetResult());
+        }
+
+        AAIController* Controller = Request.Controller;
+        APawn* Pawn = Controller ? Controller->GetPawn() : nullptr;
+
+        if (!Pawn)
+        {
+            Request.Callback.ExecuteIfBound(EMGDNMoveResult::Failed_InvalidController);
+            continue;
+        }
+
+        UMGDNNavVolumeComponent* Vol = Request.Platform
+            ? Request.Platform->FindComponentByClass<UMGDNNavVolumeComponent>()
+            : nullptr;
+
+        if (!Vol || !Vol->SourceAsset)
+        {
+            Request.Callback.ExecuteIfBound(EMGDNMoveResult::Failed_NoPlatform);
+            continue;
+        }
+
+        if (!Result.bFound)
+        {
+            Request.Callback.ExecuteIfBound(EMGDNMoveResult::Failed_NoPath);
+            continue;
+        }
+
+        AActor* Platform = Request.Platform;
+
+        // Get capsule sizes and make a fallback if no capsule which is an edge case
+        float CapsuleR = 40.f;
+        float CapsuleH = 88.f;
+
+        if (UCapsuleComponent* Capsule = Cast<UCapsuleComponent>(Pawn->GetRootComponent()))
+        {
+            CapsuleR = Capsule->GetScaledCapsuleRadius();
+            CapsuleH = Capsule->GetScaledCapsuleHalfHeight();
+        }
+
+        // A bit increase the radius
+        const float SafeX = CapsuleR * 1.25f;
+        const float SafeY = CapsuleR * 1.25f;
+
+        // Path points are in the frame the worker searched in, the pawn is where it is now
+        const FTransform& SearchT = Request.PlatformTransform;
+        const FTransform T = Platform->GetActorTransform();
+        FVector PawnLocal = T.InverseTransformPosition(Pawn->GetActorLocation());
+        FVector EndLocal  = T.InverseTransformPosition(Request.Goal);
+
+        // Cache HalfSize 
+        const FVector HS = Vol->SourceAsset->HalfSize;
+
+        TArray<FVector> LocalPath;
+        LocalPath.Reserve(Result.WorldPath.Num());
+        for (const FVector& W : Result.WorldPath)
+        {
+            FVector P = SearchT.InverseTransformPosition(W);
+
+            // Keep Z 
+            P.Z = PawnLocal.Z;
+
+            // Clamp path so spline not in edges
+            P.X = FMath::Clamp(P.X, -HS.X + SafeX, HS.X - SafeX);
+            P.Y = FMath::Clamp(P.Y, -HS.Y + SafeY, HS.Y - SafeY);
+
+            LocalPath.Add(P);
+        }
+
+        USplineComponent* Spline =
+            CreateSplinePath(Platform, PawnLocal, LocalPath, SafeX);
+
+        if (!Spline)
+        {
+            Request.Callback.ExecuteIfBound(EMGDNMoveResult::Failed_MoveRequest);
+            continue;
+        }
+
+        FMGDNActiveMove Move;
+        Move.Controller = Controller;
+        Move.Platform = Platform;
+        Move.Goal = Request.Goal;
+        Move.LocalGoal = EndLocal;
+        Move.Spline = Spline;
+
+        Move.MoveSpeed = Request.MoveSpeed;
+        Move.SplineDistance = 0.f;
+        Move.AcceptanceRadius = Request.AcceptanceRadius;
+        Move.Callback = Request.Callback;
+        Move.FlowField = MoveTemp(Result.FlowField);
+        Move.Query = Request.Query;
+        Move.RuntimeNav = Request.RuntimeNav;
+        Move.NavVersion = Request.NavVersion;
+        Move.FollowTarget = Request.FollowTarget;
+        Move.bFollowTarget = !Request.FollowTarget.IsExplicitlyNull();
+        Move.FollowCooldown = FollowReplanInterval;
+
+        ActiveMoves.Add(Move);
+    }
+}
+
+void UMGDynamicNavigationSubsystem::WaitForPathRequests(const UMGDNRuntimeNavMesh* Nav)
+{
+    for (FMGDNPathRequest& Request : PendingPaths)
+    {
+        if (Nav && Request.RuntimeNav != Nav)
+            continue;
+
+        if (Request.Sliced)
+        {
+            // Finished and turned into world points against the current data, its cell indices would mean nothing after a rebuild
+            if (Request.RuntimeNav)
+            {
+                Request.RuntimeNav->StepSlicedSearch(*Request.Sliced, MAX_int32);
+            }
+            Request.Sliced->bDone = true;
+            ResolveSlicedPathRequest(Request);
+        }
+        else
+        {
+            Request.Task.Wait();
+        }
+    }
+}
+
+void UMGDynamicNavigationSubsystem::ResolveSlicedPathRequest(FMGDNPathRequest& Request)
+{
+    if (Request.bSlicedResolved)
+        return;
+
+    Request.bSlicedResolved = true;
+    Request.SlicedResult.bFound = Request.RuntimeNav && Request.RuntimeNav->ResolveSlicedPath(
+        *Request.Sliced, Request.PlatformTransform, Request.Query, Request.SlicedResult.WorldPath);
+
+    // Only the world path is read from here on
+    Request.Sliced->Path.Empty();
+}
+
+bool UMGDynamicNavigationSubsystem::HasRunningPathRequests(const UMGDNRuntimeNavMesh* Nav) const
+{
+    for (const FMGDNPathRequest& Request : PendingPaths)
+    {
+        if (Request.RuntimeNav == Nav && !Request.bHeld && !Request.Sliced && !Request.Task.IsCompleted())
+            return true;
+    }
+
+    return false;
 }
 
 void UMGDynamicNavigationSubsystem::MoveDirectMGDNAsync(
@@ -855,6 +1575,51 @@ bool UMGDynamicNavigationSubsystem::IsPawnOnPlatform(APawn* Pawn) const
     return false;
 }
 
+bool UMGDynamicNavigationSubsystem::FindPathToNearestMGDN(APawn* Pawn, const TArray<FVector>& Goals, int32& OutGoalIndex,
+                                                          TArray<FVector>& OutPath)
+{
+    OutGoalIndex = INDEX_NONE;
+    OutPath.Reset();
+
+    if (!Pawn || Goals.Num() == 0)
+        return false;
+
+    const FVector PawnLoc = Pawn->GetActorLocation();
+
+    for (const FMGDNInstance& I : Instances)
+    {
+        if (!I.VolumeComp || !I.VolumeComp->SourceAsset || !I.RuntimeNav) continue;
+
+        AActor* Owner = I.VolumeComp->GetOwner();
+        if (!Owner) continue;
+
+        const FTransform T = Owner->GetActorTransform();
+        const FVector L = T.InverseTransformPosition(PawnLoc);
+        const FVector HS = I.VolumeComp->SourceAsset->HalfSize;
+
+        if (L.X < -HS.X || L.X > HS.X ||
+            L.Y < -HS.Y || L.Y > HS.Y ||
+            L.Z < -HS.Z || L.Z > HS.Z)
+            continue;
+
+        // Same grid and clearance a move of this pawn would search
+        FMGDNPathQuery Query = PathQuery;
+        const UMGDNRuntimeNavMesh* AgentNav = I.RuntimeNav;
+
+        if (const UCapsuleComponent* Capsule = Cast<UCapsuleComponent>(Pawn->GetRootComponent()))
+        {
+            Query.AgentRadius = FMath::Max(Query.AgentRadius, Capsule->GetScaledCapsuleRadius());
+            AgentNav = I.VolumeComp->GetRuntimeNavFor(
+                Capsule->GetScaledCapsuleRadius(), Capsule->GetScaledCapsuleHalfHeight() * 2.f);
+        }
+
+        return AgentNav->FindNearestPath(T, PawnLoc, Goals, OutPath, OutGoalIndex, Query);
+    }
+
+    UE_LOG(LogTemp, Warning, TEXT("[MGDN] FindPathToNearestMGDN: %s is not on any platform"), *Pawn->GetName());
+    return false;
+}
+
 bool UMGDynamicNavigationSubsystem::IsControllerOnPlatform(AAIController* Controller) const
 {
     return (Controller && Controller->GetPawn()) ?
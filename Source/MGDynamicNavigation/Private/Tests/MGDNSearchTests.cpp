@@ -0,0 +1,1114 @@
+﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
+#include "Misc/AutomationTest.h"
+#include "MGDNNavDataAsset.h"
+#include "MGDNRuntimeNavMesh.h"
+#include "MGDNWalkableBits.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Grid level checks of the searches against plain A* path costs, and of plain A* against a Dijkstra reference.
+// Every test bakes the same kind of small ship: decks on even layers joined by ramp wells, bulkheads with
+// doors, clutter and raised floor cells that block some moves. Costs are measured on the returned cells,
+// so a search that hands back a broken or longer path fails whatever its own bookkeeping says.
+
+namespace MGDNSearchTests
+{
+	constexpr float CostTolerance = 1e-3f;
+
+	UMGDNNavDataAsset* MakeShipAsset(int32 GX, int32 GY, int32 GZ, int32 Seed,
+	                                 EMGDNCellLayout Layout = EMGDNCellLayout::Linear, bool bSparse = false)
+	{
+		UMGDNNavDataAsset* Asset = NewObject<UMGDNNavDataAsset>();
+		Asset->GridX = GX;
+		Asset->GridY = GY;
+		Asset->GridZ = GZ;
+		Asset->CellSize = 100.f;
+		Asset->CellHeight = 100.f;
+		Asset->HalfSize = FVector(GX * 50.f, GY * 50.f, GZ * 50.f);
+		Asset->Layout = Layout;
+
+		TArray<FMGDNGridNode> Dense;
+		Dense.SetNum(GX * GY * GZ);
+
+		FRandomStream Random(Seed);
+
+		for (int32 Z = 0; Z < GZ; ++Z)
+		{
+			for (int32 Y = 0; Y < GY; ++Y)
+			{
+				for (int32 X = 0; X < GX; ++X)
+				{
+					FMGDNGridNode& Node = Dense[X + Y * GX + Z * GX * GY];
+					const bool bDeck = Z % 2 == 0;
+					const bool bBulkhead = X % 20 == 10 && Y % 15 > 2;
+
+					Node.bWalkable = bDeck && !bBulkhead && Random.FRand() > 0.08f;
+					Node.Height = Z * Asset->CellHeight - Asset->HalfSize.Z;
+
+					if (!bDeck && X % 37 == 5 && Y % 11 == 3)
+					{
+						Node.bWalkable = true;
+						Node.bIsRamp = true;
+					}
+					else if (Node.bWalkable && Random.FRand() < 0.03f)
+					{
+						// Above the step height, moves onto it need a ramp
+						Node.Height += 60.f;
+					}
+				}
+			}
+		}
+
+		if (bSparse)
+		{
+			Asset->SetSpansFromDense(Dense);
+		}
+		else
+		{
+			Asset->SetNodesFromDense(Dense);
+		}
+		return Asset;
+	}
+
+	UMGDNRuntimeNavMesh* MakeNav(const UMGDNNavDataAsset* Asset, EMGDNSearchMode Mode = EMGDNSearchMode::AStar, int32 NumLandmarks = 0)
+	{
+		UMGDNRuntimeNavMesh* Nav = NewObject<UMGDNRuntimeNavMesh>();
+		Nav->DefaultSearchMode = Mode;
+		Nav->NumLandmarks = NumLandmarks;
+		Nav->PathCacheSize = 0;
+		Nav->BuildFromAsset(Asset);
+		return Nav;
+	}
+
+	bool IsWalkable(const UMGDNNavDataAsset* Asset, int32 X, int32 Y, int32 Z)
+	{
+		const FMGDNGridNode* Node = Asset->FindNode(X, Y, Z);
+		return Node && Node->bWalkable;
+	}
+
+	TArray<int32> WalkableCells(const UMGDNNavDataAsset* Asset)
+	{
+		TArray<int32> Cells;
+		for (int32 Z = 0; Z < Asset->GridZ; ++Z)
+		for (int32 Y = 0; Y < Asset->GridY; ++Y)
+		for (int32 X = 0; X < Asset->GridX; ++X)
+		{
+			if (IsWalkable(Asset, X, Y, Z))
+			{
+				Cells.Add(Asset->Index(X, Y, Z));
+			}
+		}
+		return Cells;
+	}
+
+	// Cost of Path in cells, each step priced like the A* kernels price it for Query. False when a step is no move of Query.
+	bool PathCost(const UMGDNRuntimeNavMesh* Nav, const UMGDNNavDataAsset* Asset, const TArray<int32>& Path,
+	              const FMGDNPathQuery& Query, float& OutCost)
+	{
+		constexpr float Lengths[4] = { 0.f, 1.f, UE_SQRT_2, UE_SQRT_3 };
+
+		OutCost = 0.f;
+		for (int32 i = 1; i < Path.Num(); ++i)
+		{
+			int32 AX, AY, AZ, BX, BY, BZ;
+			MGDNCellLayout::ToXYZ(Asset->Layout, Asset->GridX, Asset->GridY, Path[i - 1], AX, AY, AZ);
+			MGDNCellLayout::ToXYZ(Asset->Layout, Asset->GridX, Asset->GridY, Path[i], BX, BY, BZ);
+
+			const FIntVector D(BX - AX, BY - AY, BZ - AZ);
+			if (FMath::Max3(FMath::Abs(D.X), FMath::Abs(D.Y), FMath::Abs(D.Z)) != 1)
+				return false;
+
+			// Between neighbours the line of sight is the move itself
+			if (!Nav->HasLineOfSight(Path[i - 1], Path[i], Query))
+				return false;
+
+			float Step = Query.StepCost == EMGDNStepCost::Unit ? 1.f : Lengths[(D.X != 0) + (D.Y != 0) + (D.Z != 0)];
+			if (Query.bUseCellCosts)
+			{
+				Step *= Nav->GetCellCost(Path[i]);
+			}
+			OutCost += Step;
+		}
+		return true;
+	}
+
+	// Dijkstra over every move of Query between neighbouring cells, priced like PathCost. Ignores clearance, -1 without a path.
+	float ReferenceCost(const UMGDNRuntimeNavMesh* Nav, const UMGDNNavDataAsset* Asset, int32 Start, int32 End,
+	                    const FMGDNPathQuery& Query)
+	{
+		TArray<float> Costs;
+		Costs.Init(FLT_MAX, Asset->NumIndices());
+		Costs[Start] = 0.f;
+
+		using FOpen = TPair<float, int32>;
+		auto Cheaper = [](const FOpen& A, const FOpen& B) { return A.Key < B.Key; };
+
+		TArray<FOpen> Open;
+		Open.HeapPush(FOpen(0.f, Start), Cheaper);
+
+		while (Open.Num() > 0)
+		{
+			FOpen Top;
+			Open.HeapPop(Top, Cheaper, EAllowShrinking::No);
+
+			const int32 Cell = Top.Value;
+			if (Top.Key > Costs[Cell])
+				continue;
+			if (Cell == End)
+				return Top.Key;
+
+			int32 X, Y, Z;
+			MGDNCellLayout::ToXYZ(Asset->Layout, Asset->GridX, Asset->GridY, Cell, X, Y, Z);
+
+			for (int32 DZ = -1; DZ <= 1; ++DZ)
+			for (int32 DY = -1; DY <= 1; ++DY)
+			for (int32 DX = -1; DX <= 1; ++DX)
+			{
+				const int32 NX = X + DX, NY = Y + DY, NZ = Z + DZ;
+				if ((DX | DY | DZ) == 0 || NX < 0 || NY < 0 || NZ < 0 ||
+					NX >= Asset->GridX || NY >= Asset->GridY || NZ >= Asset->GridZ)
+					continue;
+
+				const int32 Next = Asset->Index(NX, NY, NZ);
+				TArray<int32> Step;
+				Step.Add(Cell);
+				Step.Add(Next);
+
+				float StepCost;
+				if (!IsWalkable(Asset, NX, NY, NZ) || !PathCost(Nav, Asset, Step, Query, StepCost))
+					continue;
+
+				if (Top.Key + StepCost < Costs[Next])
+				{
+					Costs[Next] = Top.Key + StepCost;
+					Open.HeapPush(FOpen(Costs[Next], Next), Cheaper);
+				}
+			}
+		}
+
+		return -1.f;
+	}
+
+	// Cost of a path some search returned for Query, -2 when it leaves Start or misses End or takes a move Query does not allow
+	float CheckedCost(const UMGDNRuntimeNavMesh* Nav, const UMGDNNavDataAsset* Asset, const TArray<int32>& Path,
+	                  int32 Start, int32 End, const FMGDNPathQuery& Query)
+	{
+		float Cost;
+		if (Path.Num() == 0 || Path[0] != Start || Path.Last() != End || !PathCost(Nav, Asset, Path, Query, Cost))
+			return -2.f;
+		return Cost;
+	}
+
+	// Cost of the path FindIndexPath returns for Query, -1 without a path
+	float SearchCost(const UMGDNRuntimeNavMesh* Nav, const UMGDNNavDataAsset* Asset, int32 Start, int32 End,
+	                 const FMGDNPathQuery& Query)
+	{
+		TArray<int32> Path;
+		if (!Nav->FindIndexPath(Start, End, Path, Query))
+			return -1.f;
+		return CheckedCost(Nav, Asset, Path, Start, End, Query);
+	}
+
+	// Plain A* cost from Start to End, -1 without a path
+	float PlainCost(const UMGDNRuntimeNavMesh* Nav, const UMGDNNavDataAsset* Asset, int32 Start, int32 End, float AgentRadius = 0.f)
+	{
+		FMGDNPathQuery Query;
+		Query.SearchMode = EMGDNSearchMode::AStar;
+		Query.AgentRadius = AgentRadius;
+		return SearchCost(Nav, Asset, Start, End, Query);
+	}
+
+	// Blocks or reopens a few cells between plans, one of them on Path so a repair has work to do. Never Keep0 or Keep1.
+	void ChangeCells(UMGDNRuntimeNavMesh* Nav, const TArray<int32>& Cells, FRandomStream& Random, const TArray<int32>& Path,
+	                 int32 Keep0, int32 Keep1)
+	{
+		TArray<int32> Changed;
+		for (int32 i = 0; i < 6; ++i)
+		{
+			Changed.Add(Cells[Random.RandHelper(Cells.Num())]);
+		}
+		if (Path.Num() > 4)
+		{
+			Changed.Add(Path[Path.Num() / 2]);
+		}
+		Changed.Remove(Keep0);
+		Changed.Remove(Keep1);
+		Nav->SetCellsBlocked(Changed, Random.FRand() < 0.7f);
+	}
+}
+
+using namespace MGDNSearchTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNAStarTest, "MGDynamicNavigation.Search.AStar",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNAStarTest::RunTest(const FString& Parameters)
+{
+	const UMGDNNavDataAsset* Asset = MakeShipAsset(96, 48, 5, 7);
+	const TArray<int32> Cells = WalkableCells(Asset);
+
+	const UMGDNRuntimeNavMesh* Nav = MakeNav(Asset);
+
+	FRandomStream Random(11);
+
+	for (int32 Query = 0; Query < 80; ++Query)
+	{
+		const int32 Start = Cells[Random.RandHelper(Cells.Num())];
+		const int32 End   = Cells[Random.RandHelper(Cells.Num())];
+
+		TestEqual(FString::Printf(TEXT("A* %d -> %d"), Start, End),
+			PlainCost(Nav, Asset, Start, End), ReferenceCost(Nav, Asset, Start, End, FMGDNPathQuery()), CostTolerance);
+
+		// Search state comes back from the pool for every query, nothing of the last one may leak into the next
+		TArray<int32> First, Second;
+		Nav->FindIndexPath(Start, End, First);
+		Nav->FindIndexPath(Start, End, Second);
+		TestTrue(FString::Printf(TEXT("A* %d -> %d repeated"), Start, End), First == Second);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNJumpPointTest, "MGDynamicNavigation.Search.JumpPoint",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNJumpPointTest::RunTest(const FString& Parameters)
+{
+	const UMGDNNavDataAsset* Asset = MakeShipAsset(96, 48, 5, 7);
+	const TArray<int32> Cells = WalkableCells(Asset);
+
+	const UMGDNRuntimeNavMesh* Plain     = MakeNav(Asset);
+	const UMGDNRuntimeNavMesh* JumpPoint = MakeNav(Asset, EMGDNSearchMode::JumpPoint);
+
+	FMGDNPathQuery Q;
+	Q.SearchMode = EMGDNSearchMode::JumpPoint;
+
+	FRandomStream Random(23);
+
+	for (int32 Query = 0; Query < 80; ++Query)
+	{
+		const int32 Start = Cells[Random.RandHelper(Cells.Num())];
+		const int32 End   = Cells[Random.RandHelper(Cells.Num())];
+
+		TestEqual(FString::Printf(TEXT("JumpPoint %d -> %d"), Start, End),
+			SearchCost(JumpPoint, Asset, Start, End, Q), PlainCost(Plain, Asset, Start, End), CostTolerance);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNHierarchicalTest, "MGDynamicNavigation.Search.Hierarchical",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNHierarchicalTest::RunTest(const FString& Parameters)
+{
+	const UMGDNNavDataAsset* Asset = MakeShipAsset(96, 48, 5, 7);
+	const TArray<int32> Cells = WalkableCells(Asset);
+
+	const UMGDNRuntimeNavMesh* Plain        = MakeNav(Asset);
+	const UMGDNRuntimeNavMesh* Hierarchical = MakeNav(Asset, EMGDNSearchMode::Hierarchical);
+
+	FMGDNPathQuery Q;
+	Q.SearchMode = EMGDNSearchMode::Hierarchical;
+
+	FRandomStream Random(29);
+
+	for (int32 Query = 0; Query < 80; ++Query)
+	{
+		const int32 Start = Cells[Random.RandHelper(Cells.Num())];
+		const int32 End   = Cells[Random.RandHelper(Cells.Num())];
+
+		// Refined over cluster entrances, near optimal only
+		const float Expected = PlainCost(Plain, Asset, Start, End);
+		const float Cost = SearchCost(Hierarchical, Asset, Start, End, Q);
+
+		TestEqual(FString::Printf(TEXT("Hierarchical %d -> %d found"), Start, End), int32(Cost >= 0.f), int32(Expected >= 0.f));
+		if (Cost >= 0.f && Expected >= 0.f)
+		{
+			TestTrue(FString::Printf(TEXT("Hierarchical %d -> %d cost %.2f of %.2f"), Start, End, Cost, Expected),
+				Cost >= Expected - CostTolerance && Cost <= Expected * 1.3f + CostTolerance);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNNeighborMaskTest, "MGDynamicNavigation.Grid.NeighborMasks",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNNeighborMaskTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(31);
+
+	// Odd sizes put rows and layers at every bit offset within the words
+	for (const FIntVector Size : { FIntVector(3, 3, 2), FIntVector(17, 5, 3), FIntVector(63, 9, 4), FIntVector(70, 33, 5) })
+	{
+		FMGDNWalkableBits Bits;
+		Bits.Init(Size.X, Size.Y, Size.Z);
+
+		const int32 Num = Size.X * Size.Y * Size.Z;
+		for (int32 i = 0; i < Num; ++i)
+		{
+			Bits.Set(i, Random.FRand() < 0.6f);
+		}
+
+		int32 Wrong = 0;
+		for (int32 Z = 0; Z < Size.Z; ++Z)
+		for (int32 Y = 0; Y < Size.Y; ++Y)
+		for (int32 X = 0; X < Size.X; ++X)
+		{
+			uint32 Expected = 0;
+			for (int32 DZ = -1; DZ <= 1; ++DZ)
+			for (int32 DY = -1; DY <= 1; ++DY)
+			for (int32 DX = -1; DX <= 1; ++DX)
+			{
+				const int32 NX = X + DX, NY = Y + DY, NZ = Z + DZ;
+				if (NX >= 0 && NY >= 0 && NZ >= 0 && NX < Size.X && NY < Size.Y && NZ < Size.Z &&
+					Bits[NX + NY * Size.X + NZ * Size.X * Size.Y])
+				{
+					Expected |= 1u << FMGDNWalkableBits::BitOf(DX, DY, DZ);
+				}
+			}
+
+			Wrong += Bits.NeighborMask(X + Y * Size.X + Z * Size.X * Size.Y, X, Y) != Expected;
+		}
+
+		TestEqual(FString::Printf(TEXT("Masks of %dx%dx%d"), Size.X, Size.Y, Size.Z), Wrong, 0);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNBrickLayoutTest, "MGDynamicNavigation.Grid.BrickLayout",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNBrickLayoutTest::RunTest(const FString& Parameters)
+{
+	// Sizes off the brick edge, so the last bricks are part padding
+	const UMGDNNavDataAsset* Linear = MakeShipAsset(70, 45, 5, 37);
+	const UMGDNNavDataAsset* Brick  = MakeShipAsset(70, 45, 5, 37, EMGDNCellLayout::Brick);
+
+	int32 Wrong = 0;
+	for (int32 Z = 0; Z < Brick->GridZ; ++Z)
+	for (int32 Y = 0; Y < Brick->GridY; ++Y)
+	for (int32 X = 0; X < Brick->GridX; ++X)
+	{
+		int32 BX, BY, BZ;
+		MGDNCellLayout::ToXYZ(Brick->Layout, Brick->GridX, Brick->GridY, Brick->Index(X, Y, Z), BX, BY, BZ);
+		Wrong += BX != X || BY != Y || BZ != Z || IsWalkable(Brick, X, Y, Z) != IsWalkable(Linear, X, Y, Z);
+	}
+	TestEqual(TEXT("Brick cells"), Wrong, 0);
+	TestEqual(TEXT("Brick walkable cells"), Brick->CountWalkable(), Linear->CountWalkable());
+
+	auto ToBrick = [Linear, Brick](int32 Index)
+	{
+		int32 X, Y, Z;
+		MGDNCellLayout::ToXYZ(Linear->Layout, Linear->GridX, Linear->GridY, Index, X, Y, Z);
+		return Brick->Index(X, Y, Z);
+	};
+
+	const TArray<int32> Cells = WalkableCells(Linear);
+
+	for (const EMGDNSearchMode Mode : { EMGDNSearchMode::AStar, EMGDNSearchMode::JumpPoint })
+	{
+		const UMGDNRuntimeNavMesh* LinearNav = MakeNav(Linear, Mode);
+		const UMGDNRuntimeNavMesh* BrickNav  = MakeNav(Brick, Mode);
+
+		FMGDNPathQuery Q;
+		Q.SearchMode = Mode;
+
+		FRandomStream Random(43);
+
+		for (int32 Query = 0; Query < 60; ++Query)
+		{
+			const int32 Start = Cells[Random.RandHelper(Cells.Num())];
+			const int32 End   = Cells[Random.RandHelper(Cells.Num())];
+
+			TestEqual(FString::Printf(TEXT("Mode %d brick %d -> %d"), int32(Mode), Start, End),
+				SearchCost(BrickNav, Brick, ToBrick(Start), ToBrick(End), Q), SearchCost(LinearNav, Linear, Start, End, Q), CostTolerance);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNSparseStorageTest, "MGDynamicNavigation.Grid.SparseStorage",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNSparseStorageTest::RunTest(const FString& Parameters)
+{
+	const UMGDNNavDataAsset* Dense  = MakeShipAsset(70, 45, 5, 47);
+	const UMGDNNavDataAsset* Sparse = MakeShipAsset(70, 45, 5, 47, EMGDNCellLayout::Linear, true);
+	const UMGDNNavDataAsset* Bricks = MakeShipAsset(70, 45, 5, 47, EMGDNCellLayout::Brick, true);
+
+	int32 Wrong = 0;
+	for (int32 Z = 0; Z < Dense->GridZ; ++Z)
+	for (int32 Y = 0; Y < Dense->GridY; ++Y)
+	for (int32 X = 0; X < Dense->GridX; ++X)
+	{
+		const FMGDNGridNode* DenseNode  = Dense->FindNode(X, Y, Z);
+		const FMGDNGridNode* SparseNode = Sparse->FindNode(X, Y, Z);
+
+		// Sparse assets only store walkable cells
+		if (DenseNode->bWalkable)
+		{
+			Wrong += !SparseNode || !SparseNode->bWalkable || SparseNode->Height != DenseNode->Height ||
+				SparseNode->bIsRamp != DenseNode->bIsRamp;
+		}
+		else
+		{
+			Wrong += SparseNode && SparseNode->bWalkable;
+		}
+	}
+	TestEqual(TEXT("Sparse cells"), Wrong, 0);
+	TestTrue(TEXT("Sparse stores no air"), Sparse->IsSparse() && Sparse->Nodes.Num() == 0 &&
+		Sparse->SpanNodes.Num() == Dense->CountWalkable());
+
+	const UMGDNRuntimeNavMesh* DenseNav  = MakeNav(Dense);
+	const UMGDNRuntimeNavMesh* SparseNav = MakeNav(Sparse);
+	const UMGDNRuntimeNavMesh* BricksNav = MakeNav(Bricks);
+
+	const TArray<int32> Cells = WalkableCells(Dense);
+	FRandomStream Random(53);
+
+	for (int32 Query = 0; Query < 60; ++Query)
+	{
+		const int32 Start = Cells[Random.RandHelper(Cells.Num())];
+		const int32 End   = Cells[Random.RandHelper(Cells.Num())];
+
+		int32 SX, SY, SZ, EX, EY, EZ;
+		MGDNCellLayout::ToXYZ(Dense->Layout, Dense->GridX, Dense->GridY, Start, SX, SY, SZ);
+		MGDNCellLayout::ToXYZ(Dense->Layout, Dense->GridX, Dense->GridY, End, EX, EY, EZ);
+
+		const float Expected = PlainCost(DenseNav, Dense, Start, End);
+		TestEqual(FString::Printf(TEXT("Sparse %d -> %d"), Start, End),
+			PlainCost(SparseNav, Sparse, Start, End), Expected, CostTolerance);
+		TestEqual(FString::Printf(TEXT("Sparse bricks %d -> %d"), Start, End),
+			PlainCost(BricksNav, Bricks, Bricks->Index(SX, SY, SZ), Bricks->Index(EX, EY, EZ)), Expected, CostTolerance);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNCropTest, "MGDynamicNavigation.Grid.Crop",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNCropTest::RunTest(const FString& Parameters)
+{
+	// Borders on every side of the volume box are empty, the cropped grid keeps only the ship
+	const FIntVector Margin(3, 5, 1);
+
+	UMGDNNavDataAsset* Cropped = MakeShipAsset(60, 40, 3, 59, EMGDNCellLayout::Linear, true);
+
+	UMGDNNavDataAsset* Full = NewObject<UMGDNNavDataAsset>();
+	Full->GridX = Cropped->GridX + Margin.X * 2;
+	Full->GridY = Cropped->GridY + Margin.Y * 2;
+	Full->GridZ = Cropped->GridZ + Margin.Z * 2;
+	Full->CellSize = Cropped->CellSize;
+	Full->CellHeight = Cropped->CellHeight;
+	Full->HalfSize = FVector(Full->GridX * 50.f, Full->GridY * 50.f, Full->GridZ * 50.f);
+
+	TArray<FMGDNGridNode> Nodes;
+	Nodes.SetNum(Full->GridX * Full->GridY * Full->GridZ);
+	for (int32 Z = 0; Z < Cropped->GridZ; ++Z)
+	for (int32 Y = 0; Y < Cropped->GridY; ++Y)
+	for (int32 X = 0; X < Cropped->GridX; ++X)
+	{
+		if (const FMGDNGridNode* Node = Cropped->FindNode(X, Y, Z))
+		{
+			Nodes[(X + Margin.X) + (Y + Margin.Y) * Full->GridX + (Z + Margin.Z) * Full->GridX * Full->GridY] = *Node;
+		}
+	}
+	Full->SetNodesFromDense(Nodes);
+
+	Cropped->HalfSize = Full->HalfSize;
+	Cropped->CellOffset = Margin;
+
+	const UMGDNRuntimeNavMesh* FullNav    = MakeNav(Full);
+	const UMGDNRuntimeNavMesh* CroppedNav = MakeNav(Cropped);
+
+	// The same world points resolve to the same cells, and paths come back at the same places
+	const TArray<int32> Cells = WalkableCells(Full);
+	FRandomStream Random(61);
+
+	for (int32 Query = 0; Query < 60; ++Query)
+	{
+		const FVector Start = FullNav->GetCellCenterLocal(Cells[Random.RandHelper(Cells.Num())]);
+		const FVector End   = FullNav->GetCellCenterLocal(Cells[Random.RandHelper(Cells.Num())]);
+
+		TArray<FVector> FullPath, CroppedPath;
+		const bool bFullFound    = FullNav->FindPath(FTransform::Identity, Start, End, FullPath);
+		const bool bCroppedFound = CroppedNav->FindPath(FTransform::Identity, Start, End, CroppedPath);
+
+		bool bSame = bFullFound == bCroppedFound && FullPath.Num() == CroppedPath.Num();
+		for (int32 i = 0; bSame && i < FullPath.Num(); ++i)
+		{
+			bSame = FullPath[i].Equals(CroppedPath[i], 0.01f);
+		}
+		TestTrue(FString::Printf(TEXT("Cropped %s -> %s"), *Start.ToString(), *End.ToString()), bSame);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNSlicedSearchTest, "MGDynamicNavigation.Search.Sliced",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNSlicedSearchTest::RunTest(const FString& Parameters)
+{
+	const UMGDNNavDataAsset* Asset = MakeShipAsset(96, 48, 5, 67);
+	const TArray<int32> Cells = WalkableCells(Asset);
+
+	UMGDNRuntimeNavMesh* Nav = MakeNav(Asset);
+
+	FRandomStream Random(71);
+
+	// Resumed a small budget at a time, the search ends where one uninterrupted A* run does
+	for (int32 Query = 0; Query < 60; ++Query)
+	{
+		const int32 Start = Cells[Random.RandHelper(Cells.Num())];
+		const int32 End   = Cells[Random.RandHelper(Cells.Num())];
+
+		FMGDNSlicedSearch Search;
+		Nav->BeginSlicedSearch(Start, End, Search);
+
+		int32 Slices = 0;
+		while (!Nav->StepSlicedSearch(Search, 40) && Slices < 100000)
+		{
+			Slices++;
+		}
+
+		const float Cost = Search.bFound ? CheckedCost(Nav, Asset, Search.Path, Start, End, FMGDNPathQuery()) : -1.f;
+		TestTrue(FString::Printf(TEXT("Sliced %d -> %d done"), Start, End), Search.bDone);
+		TestEqual(FString::Printf(TEXT("Sliced %d -> %d"), Start, End), Cost, PlainCost(Nav, Asset, Start, End), CostTolerance);
+	}
+
+	// Rebuilt while searches are pending: a path resolved before keeps its places, cells read afterwards are refused
+	int32 Start = INDEX_NONE, End = INDEX_NONE;
+	while (Start == INDEX_NONE || PlainCost(Nav, Asset, Start, End) < 30.f)
+	{
+		Start = Cells[Random.RandHelper(Cells.Num())];
+		End   = Cells[Random.RandHelper(Cells.Num())];
+	}
+
+	FMGDNPathQuery Q;
+	FMGDNSlicedSearch Resolved, Found, Pending;
+	Nav->BeginSlicedSearch(Start, End, Resolved, Q);
+	Nav->BeginSlicedSearch(Start, End, Found, Q);
+	Nav->BeginSlicedSearch(Start, End, Pending, Q);
+	Nav->StepSlicedSearch(Resolved, MAX_int32);
+	Nav->StepSlicedSearch(Found, MAX_int32);
+	TestFalse(TEXT("Pending after one slice"), Nav->StepSlicedSearch(Pending, 20));
+
+	TArray<FVector> Before, Expected;
+	Nav->ResolveSlicedPath(Resolved, FTransform::Identity, Q, Before);
+	Nav->FindPath(FTransform::Identity, Nav->GetCellCenterLocal(Start), Nav->GetCellCenterLocal(End), Expected, Q);
+	TestTrue(TEXT("Resolved like FindPath"), Before.Num() > 0 && Before == Expected);
+
+	// Smaller grid, the old cell indices run past its end
+	Nav->BuildFromAsset(MakeShipAsset(40, 20, 3, 73));
+
+	TArray<FVector> After;
+	TestFalse(TEXT("Found before the rebuild, resolved after"), Nav->ResolveSlicedPath(Found, FTransform::Identity, Q, After));
+	TestTrue(TEXT("Pending search ends on the rebuild"), Nav->StepSlicedSearch(Pending, MAX_int32) && Pending.bDone && !Pending.bFound);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNBidirectionalTest, "MGDynamicNavigation.Search.Bidirectional",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNBidirectionalTest::RunTest(const FString& Parameters)
+{
+	const UMGDNNavDataAsset* Asset = MakeShipAsset(96, 48, 5, 7);
+	const TArray<int32> Cells = WalkableCells(Asset);
+
+	const UMGDNRuntimeNavMesh* Nav = MakeNav(Asset);
+
+	FRandomStream Random(79);
+
+	for (const float AgentRadius : { 0.f, 90.f })
+	{
+		FMGDNPathQuery Q;
+		Q.SearchMode = EMGDNSearchMode::Bidirectional;
+		Q.AgentRadius = AgentRadius;
+
+		for (int32 Query = 0; Query < 80; ++Query)
+		{
+			const int32 Start = Cells[Random.RandHelper(Cells.Num())];
+			const int32 End   = Cells[Random.RandHelper(Cells.Num())];
+
+			TestEqual(FString::Printf(TEXT("Bidirectional R=%.0f %d -> %d"), AgentRadius, Start, End),
+				SearchCost(Nav, Asset, Start, End, Q), PlainCost(Nav, Asset, Start, End, AgentRadius), CostTolerance);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNWeightedAStarTest, "MGDynamicNavigation.Search.WeightedAStar",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNWeightedAStarTest::RunTest(const FString& Parameters)
+{
+	const UMGDNNavDataAsset* Asset = MakeShipAsset(96, 48, 5, 83);
+	const TArray<int32> Cells = WalkableCells(Asset);
+
+	const UMGDNRuntimeNavMesh* Nav = MakeNav(Asset);
+
+	FRandomStream Random(89);
+
+	for (int32 Query = 0; Query < 80; ++Query)
+	{
+		const int32 Start = Cells[Random.RandHelper(Cells.Num())];
+		const int32 End   = Cells[Random.RandHelper(Cells.Num())];
+
+		const float Optimal = ReferenceCost(Nav, Asset, Start, End, FMGDNPathQuery());
+
+		// Weighted searches give up optimality, never more than their weight
+		for (const float Weight : { 1.f, 1.5f, 3.f })
+		{
+			FMGDNPathQuery Q;
+			Q.HeuristicWeight = Weight;
+
+			const float Cost = SearchCost(Nav, Asset, Start, End, Q);
+			if (Optimal < 0.f || Weight == 1.f)
+			{
+				TestEqual(FString::Printf(TEXT("W=%.1f %d -> %d"), Weight, Start, End), Cost, Optimal, CostTolerance);
+			}
+			else
+			{
+				TestTrue(FString::Printf(TEXT("W=%.1f %d -> %d cost %.2f of %.2f"), Weight, Start, End, Cost, Optimal),
+					Cost >= Optimal - CostTolerance && Cost <= Optimal * Weight + CostTolerance);
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNFlowFieldTest, "MGDynamicNavigation.Search.FlowField",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNFlowFieldTest::RunTest(const FString& Parameters)
+{
+	const UMGDNNavDataAsset* Asset = MakeShipAsset(96, 48, 5, 17);
+	const TArray<int32> Cells = WalkableCells(Asset);
+
+	const UMGDNRuntimeNavMesh* Nav = MakeNav(Asset);
+
+	FRandomStream Random(19);
+
+	for (const float AgentRadius : { 0.f, 90.f })
+	{
+		for (int32 GoalRound = 0; GoalRound < 4; ++GoalRound)
+		{
+			const int32 Goal = Cells[Random.RandHelper(Cells.Num())];
+			const TSharedPtr<const FMGDNFlowField> Field = Nav->GetFlowField(Goal, AgentRadius);
+			if (!TestTrue(FString::Printf(TEXT("Field for %d"), Goal), Field.IsValid()))
+				continue;
+
+			for (int32 Query = 0; Query < 40; ++Query)
+			{
+				const int32 Start = Cells[Random.RandHelper(Cells.Num())];
+
+				FMGDNPathQuery Q;
+				Q.AgentRadius = AgentRadius;
+
+				TArray<int32> Path;
+				const float Cost = Nav->FollowFlowField(*Field, Start, Path) ? CheckedCost(Nav, Asset, Path, Start, Goal, Q) : -1.f;
+
+				TestEqual(FString::Printf(TEXT("Flow R=%.0f %d -> %d"), AgentRadius, Start, Goal),
+					Cost, PlainCost(Nav, Asset, Start, Goal, AgentRadius), CostTolerance);
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNPathCacheTest, "MGDynamicNavigation.Grid.PathCache",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNPathCacheTest::RunTest(const FString& Parameters)
+{
+	const UMGDNNavDataAsset* Asset = MakeShipAsset(64, 40, 3, 97);
+	const TArray<int32> Cells = WalkableCells(Asset);
+
+	const UMGDNRuntimeNavMesh* Uncached = MakeNav(Asset);
+
+	UMGDNRuntimeNavMesh* Nav = NewObject<UMGDNRuntimeNavMesh>();
+	Nav->PathCacheSize = 8;
+	Nav->BuildFromAsset(Asset);
+
+	FRandomStream Random(101);
+
+	TArray<TPair<FVector, FVector>> Queries;
+	while (Queries.Num() < 12)
+	{
+		const int32 Start = Cells[Random.RandHelper(Cells.Num())];
+		const int32 End   = Cells[Random.RandHelper(Cells.Num())];
+		if (PlainCost(Uncached, Asset, Start, End) > 0.f)
+		{
+			Queries.Add(TPair<FVector, FVector>(Nav->GetCellCenterLocal(Start), Nav->GetCellCenterLocal(End)));
+		}
+	}
+
+	// Cached or not, the same path comes back
+	auto Run = [this, Nav, Uncached](const TPair<FVector, FVector>& Query, const TCHAR* Pass)
+	{
+		TArray<FVector> Path, Expected;
+		Nav->FindPath(FTransform::Identity, Query.Key, Query.Value, Path);
+		Uncached->FindPath(FTransform::Identity, Query.Key, Query.Value, Expected);
+		TestTrue(FString::Printf(TEXT("%s %s -> %s"), Pass, *Query.Key.ToString(), *Query.Value.ToString()),
+			Path.Num() > 0 && Path == Expected);
+	};
+
+	for (const TPair<FVector, FVector>& Query : Queries)
+	{
+		Run(Query, TEXT("Cold"));
+	}
+
+	FMGDNPathCacheStats Stats = Nav->GetPathCacheStats();
+	TestEqual(TEXT("Cold misses"), int32(Stats.Misses), Queries.Num());
+	TestEqual(TEXT("Entries bounded"), Stats.Entries, Nav->PathCacheSize);
+
+	// The last eight are held, newest first so each hit keeps the rest
+	for (int32 i = Queries.Num() - 1; i >= Queries.Num() - 8; --i)
+	{
+		Run(Queries[i], TEXT("Warm"));
+	}
+
+	Stats = Nav->GetPathCacheStats();
+	TestEqual(TEXT("Warm hits"), int32(Stats.Hits), 8);
+
+	// The oldest ones were dropped
+	Run(Queries[0], TEXT("Evicted"));
+	TestEqual(TEXT("Evicted misses"), int32(Nav->GetPathCacheStats().Misses), Queries.Num() + 1);
+
+	// Any grid change drops every cached path
+	Nav->MarkNavDataChanged();
+	TestEqual(TEXT("Dropped on change"), Nav->GetPathCacheStats().Entries, 0);
+	Run(Queries.Last(), TEXT("Changed"));
+	TestEqual(TEXT("Changed misses"), int32(Nav->GetPathCacheStats().Misses), Queries.Num() + 2);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNIncrementalRepairTest, "MGDynamicNavigation.Search.IncrementalRepair",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNIncrementalRepairTest::RunTest(const FString& Parameters)
+{
+	const UMGDNNavDataAsset* Asset = MakeShipAsset(80, 40, 3, 9);
+	const TArray<int32> Cells = WalkableCells(Asset);
+
+	UMGDNRuntimeNavMesh* Nav = MakeNav(Asset);
+
+	FRandomStream Random(13);
+
+	// The agent walks its path while cells change around it
+	for (int32 Round = 0; Round < 8; ++Round)
+	{
+		int32 Start = Cells[Random.RandHelper(Cells.Num())];
+		const int32 Goal = Cells[Random.RandHelper(Cells.Num())];
+
+		FMGDNIncrementalPath Incremental;
+		bool bFound = Nav->BeginIncrementalPath(Start, Goal, Incremental);
+
+		for (int32 Step = 0; Step < 10; ++Step)
+		{
+			const float Cost = bFound ? CheckedCost(Nav, Asset, Incremental.Path, Start, Goal, FMGDNPathQuery()) : -1.f;
+			TestEqual(FString::Printf(TEXT("Repair round %d step %d"), Round, Step), Cost, PlainCost(Nav, Asset, Start, Goal), CostTolerance);
+
+			if (bFound && Incremental.Path.Num() > 3)
+			{
+				Start = Incremental.Path[3];
+			}
+
+			ChangeCells(Nav, Cells, Random, Incremental.Path, Start, Goal);
+			bFound = Nav->ReplanIncrementalPath(Incremental, Start);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNObstacleTest, "MGDynamicNavigation.Grid.Obstacles",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNObstacleTest::RunTest(const FString& Parameters)
+{
+	const UMGDNNavDataAsset* Asset = MakeShipAsset(64, 40, 3, 103);
+	const TArray<int32> Cells = WalkableCells(Asset);
+
+	UMGDNRuntimeNavMesh* Nav = MakeNav(Asset);
+
+	// Two overlapping boxes across the lower deck, the second turned a little
+	const FVector Extent(250.f, 400.f, 80.f);
+	const FTransform BoxA(FVector(-800.f, 0.f, -100.f));
+	const FTransform BoxB(FRotator(0.f, 20.f, 0.f).Quaternion(), FVector(-500.f, 100.f, -100.f));
+	const FTransform BoxBMoved(FVector(900.f, -300.f, -100.f));
+
+	TArray<int32> CellsA, CellsB, CellsBMoved;
+	Nav->GatherObstacleCells(BoxA, Extent, CellsA);
+	Nav->GatherObstacleCells(BoxB, Extent, CellsB);
+	Nav->GatherObstacleCells(BoxBMoved, Extent, CellsBMoved);
+
+	// Walkable cells blocked exactly when one of the listed boxes covers them
+	auto CheckBlocked = [this, Nav, &Cells](const TCHAR* Stage, TArray<const TArray<int32>*> Boxes)
+	{
+		int32 Wrong = 0;
+		int32 Blocked = 0;
+		for (const int32 Cell : Cells)
+		{
+			bool bCovered = false;
+			for (const TArray<int32>* Box : Boxes)
+			{
+				bCovered |= Box->Contains(Cell);
+			}
+			Wrong += Nav->IsCellBlocked(Cell) != bCovered;
+			Blocked += bCovered;
+		}
+		TestEqual(FString::Printf(TEXT("%s blocked cells"), Stage), Wrong, 0);
+		TestTrue(FString::Printf(TEXT("%s blocks something"), Stage), Boxes.Num() == 0 || Blocked > 0);
+	};
+
+	TestTrue(TEXT("A closes cells"), Nav->SetObstacle(1, BoxA, Extent));
+	TestTrue(TEXT("B closes cells"), Nav->SetObstacle(2, BoxB, Extent));
+	TestFalse(TEXT("B set again in place"), Nav->SetObstacle(2, BoxB, Extent));
+	CheckBlocked(TEXT("A and B"), { &CellsA, &CellsB });
+
+	// Cells under both stay closed while either box is left
+	Nav->RemoveObstacle(1);
+	CheckBlocked(TEXT("B"), { &CellsB });
+
+	Nav->SetObstacle(1, BoxA, Extent);
+	Nav->SetObstacle(2, BoxBMoved, Extent);
+	CheckBlocked(TEXT("A and moved B"), { &CellsA, &CellsBMoved });
+
+	// Searches go around them
+	FRandomStream Random(107);
+	for (int32 Query = 0; Query < 40; ++Query)
+	{
+		const int32 Start = Cells[Random.RandHelper(Cells.Num())];
+		const int32 End   = Cells[Random.RandHelper(Cells.Num())];
+		if (Nav->IsCellBlocked(Start) || Nav->IsCellBlocked(End))
+			continue;
+
+		TestEqual(FString::Printf(TEXT("Around obstacles %d -> %d"), Start, End),
+			PlainCost(Nav, Asset, Start, End), ReferenceCost(Nav, Asset, Start, End, FMGDNPathQuery()), CostTolerance);
+	}
+
+	// Rebuilt grids are stamped again
+	Nav->BuildFromAsset(Asset);
+	CheckBlocked(TEXT("Rebuilt"), { &CellsA, &CellsBMoved });
+
+	Nav->RemoveObstacle(1);
+	Nav->RemoveObstacle(2);
+	TestFalse(TEXT("Removed twice"), Nav->RemoveObstacle(2));
+	CheckBlocked(TEXT("None"), {});
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNLandmarksTest, "MGDynamicNavigation.Search.Landmarks",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNLandmarksTest::RunTest(const FString& Parameters)
+{
+	const UMGDNNavDataAsset* Asset = MakeShipAsset(96, 48, 5, 7);
+	const TArray<int32> Cells = WalkableCells(Asset);
+
+	const UMGDNRuntimeNavMesh* Plain     = MakeNav(Asset);
+	const UMGDNRuntimeNavMesh* Landmarks = MakeNav(Asset, EMGDNSearchMode::AStar, 8);
+
+	FRandomStream Random(109);
+
+	for (const float AgentRadius : { 0.f, 90.f })
+	{
+		for (int32 Query = 0; Query < 80; ++Query)
+		{
+			const int32 Start = Cells[Random.RandHelper(Cells.Num())];
+			const int32 End   = Cells[Random.RandHelper(Cells.Num())];
+
+			TestEqual(FString::Printf(TEXT("ALT R=%.0f %d -> %d"), AgentRadius, Start, End),
+				PlainCost(Landmarks, Asset, Start, End, AgentRadius), PlainCost(Plain, Asset, Start, End, AgentRadius), CostTolerance);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNNearestGoalTest, "MGDynamicNavigation.Search.NearestGoal",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNNearestGoalTest::RunTest(const FString& Parameters)
+{
+	const UMGDNNavDataAsset* Asset = MakeShipAsset(96, 48, 5, 113);
+	const TArray<int32> Cells = WalkableCells(Asset);
+
+	const UMGDNRuntimeNavMesh* Nav = MakeNav(Asset);
+
+	FRandomStream Random(127);
+
+	for (const float AgentRadius : { 0.f, 90.f })
+	for (const int32 NumGoals : { 1, 4, 12 })
+	{
+		FMGDNPathQuery Q;
+		Q.AgentRadius = AgentRadius;
+
+		for (int32 Query = 0; Query < 20; ++Query)
+		{
+			const int32 Start = Cells[Random.RandHelper(Cells.Num())];
+
+			TArray<int32> Goals;
+			float Nearest = -1.f;
+			for (int32 i = 0; i < NumGoals; ++i)
+			{
+				Goals.Add(Cells[Random.RandHelper(Cells.Num())]);
+
+				const float Cost = PlainCost(Nav, Asset, Start, Goals.Last(), AgentRadius);
+				if (Cost >= 0.f && (Nearest < 0.f || Cost < Nearest))
+				{
+					Nearest = Cost;
+				}
+			}
+
+			TArray<int32> Path;
+			int32 Goal = INDEX_NONE;
+			float Cost = -1.f;
+			if (Nav->FindNearestGoalPath(Start, Goals, Path, Goal, Q))
+			{
+				Cost = Goals.IsValidIndex(Goal) ? CheckedCost(Nav, Asset, Path, Start, Goals[Goal], Q) : -2.f;
+			}
+
+			TestEqual(FString::Printf(TEXT("Nearest of %d R=%.0f from %d"), NumGoals, AgentRadius, Start), Cost, Nearest, CostTolerance);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNFollowTargetTest, "MGDynamicNavigation.Search.FollowTarget",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNFollowTargetTest::RunTest(const FString& Parameters)
+{
+	const UMGDNNavDataAsset* Asset = MakeShipAsset(80, 40, 3, 9);
+	const TArray<int32> Cells = WalkableCells(Asset);
+
+	UMGDNRuntimeNavMesh* Nav = MakeNav(Asset);
+
+	FRandomStream Random(131);
+
+	// Moving Target D* Lite chasing a target that wanders while the agent walks towards it
+	for (int32 Round = 0; Round < 6; ++Round)
+	{
+		int32 Agent  = Cells[Random.RandHelper(Cells.Num())];
+		int32 Target = Cells[Random.RandHelper(Cells.Num())];
+
+		FMGDNIncrementalPath Follow;
+		for (int32 Step = 0; Step < 12; ++Step)
+		{
+			const bool bFound = Nav->FollowIncrementalPath(Follow, Agent, Target);
+
+			const float Cost = bFound ? CheckedCost(Nav, Asset, Follow.Path, Agent, Target, FMGDNPathQuery()) : -1.f;
+			TestEqual(FString::Printf(TEXT("Follow round %d step %d"), Round, Step), Cost, PlainCost(Nav, Asset, Agent, Target), CostTolerance);
+
+			if (bFound && Follow.Path.Num() > 2)
+			{
+				Agent = Follow.Path[2];
+			}
+
+			// The target keeps to cells near its path end most of the time, jumps away now and then
+			if (bFound && Random.FRand() < 0.8f && Follow.Path.Num() > 1)
+			{
+				Target = Follow.Path[Follow.Path.Num() - 2];
+			}
+			else
+			{
+				Target = Cells[Random.RandHelper(Cells.Num())];
+			}
+
+			if (Step % 4 == 3)
+			{
+				ChangeCells(Nav, Cells, Random, Follow.Path, Agent, Target);
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMGDNPolicyKernelsTest, "MGDynamicNavigation.Search.PolicyKernels",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FMGDNPolicyKernelsTest::RunTest(const FString& Parameters)
+{
+	const UMGDNNavDataAsset* Asset = MakeShipAsset(64, 40, 5, 3);
+	const TArray<int32> Cells = WalkableCells(Asset);
+
+	UMGDNRuntimeNavMesh* Nav = MakeNav(Asset, EMGDNSearchMode::AStar, 6);
+
+	FRandomStream Random(5);
+
+	TArray<int32> Costly, Blocked;
+	for (int32 i = 0; i < Cells.Num() / 6; ++i)
+	{
+		Costly.Add(Cells[Random.RandHelper(Cells.Num())]);
+	}
+	for (int32 i = 0; i < 30; ++i)
+	{
+		Blocked.Add(Cells[Random.RandHelper(Cells.Num())]);
+	}
+	Nav->SetCellCosts(Costly, 4.f);
+	Nav->SetCellsBlocked(Blocked, true);
+
+	// All 24 kernels: move set, step cost, cell costs and clearance
+	for (const EMGDNMoveSet MoveSet : { EMGDNMoveSet::Faces6, EMGDNMoveSet::Edges18, EMGDNMoveSet::Corners26 })
+	for (const EMGDNStepCost StepCost : { EMGDNStepCost::Octile, EMGDNStepCost::Unit })
+	for (const bool bCellCosts : { false, true })
+	for (const float AgentRadius : { 0.f, 120.f })
+	{
+		FMGDNPathQuery Q;
+		Q.MoveSet = MoveSet;
+		Q.StepCost = StepCost;
+		Q.bUseCellCosts = bCellCosts;
+		Q.AgentRadius = AgentRadius;
+
+		// The reference ignores clearance, with a radius the kernel is held to its own search without a heuristic
+		FMGDNPathQuery Dijkstra = Q;
+		Dijkstra.HeuristicWeight = 0.f;
+
+		const FString Kernel = FString::Printf(TEXT("Moves=%d Unit=%d Costs=%d R=%.0f"),
+			int32(MoveSet), int32(StepCost), int32(bCellCosts), AgentRadius);
+
+		for (int32 Query = 0; Query < 25; ++Query)
+		{
+			const int32 Start = Cells[Random.RandHelper(Cells.Num())];
+			const int32 End   = Cells[Random.RandHelper(Cells.Num())];
+
+			float Expected = -1.f;
+			if (AgentRadius > 0.f)
+			{
+				Expected = SearchCost(Nav, Asset, Start, End, Dijkstra);
+			}
+			else if (Nav->IsCellBlocked(Start) || Nav->IsCellBlocked(End))
+			{
+				Expected = -1.f;
+			}
+			else
+			{
+				Expected = ReferenceCost(Nav, Asset, Start, End, Q);
+			}
+
+			TestEqual(FString::Printf(TEXT("%s %d -> %d"), *Kernel, Start, End),
+				SearchCost(Nav, Asset, Start, End, Q), Expected, CostTolerance * FMath::Max(Expected, 1.f));
+		}
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
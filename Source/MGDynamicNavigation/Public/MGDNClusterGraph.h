@@ -0,0 +1,81 @@
+﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
+#pragma once
+#include "CoreMinimal.h"
+
+/** Inclusive box of grid cells, keeps a search inside one part of the grid. */
+struct FMGDNGridBounds
+{
+	FIntVector Min = FIntVector::ZeroValue;
+	FIntVector Max = FIntVector::ZeroValue;
+
+	FORCEINLINE bool Contains(int32 X, int32 Y, int32 Z) const
+	{
+		return X >= Min.X && X <= Max.X &&
+			   Y >= Min.Y && Y <= Max.Y &&
+			   Z >= Min.Z && Z <= Max.Z;
+	}
+};
+
+struct FMGDNClusterEdge
+{
+	int32 To = INDEX_NONE;
+	float Cost = 0.f;
+};
+
+/**
+ * Abstract graph for hierarchical (HPA*) search.
+ * The grid is cut into cubic clusters. Every group of moves crossing from one cluster into
+ * another becomes an entrance with a node on each side, and nodes of the same cluster are
+ * linked with their shortest path cost inside that cluster.
+ */
+struct FMGDNClusterGraph
+{
+	int32 ClusterSize = 0;
+	FIntVector GridSize = FIntVector::ZeroValue;
+	FIntVector NumClusters = FIntVector::ZeroValue;
+
+	// Per abstract node
+	TArray<int32> NodeCell;
+	TArray<int32> NodeCluster;
+	TArray<TArray<FMGDNClusterEdge>> NodeEdges;
+
+	// Abstract nodes inside each cluster
+	TArray<TArray<int32>> ClusterNodes;
+
+	void Reset()
+	{
+		ClusterSize = 0;
+		GridSize = FIntVector::ZeroValue;
+		NumClusters = FIntVector::ZeroValue;
+		NodeCell.Reset();
+		NodeCluster.Reset();
+		NodeEdges.Reset();
+		ClusterNodes.Reset();
+	}
+
+	FORCEINLINE bool IsBuilt() const { return ClusterSize > 0; }
+
+	FORCEINLINE int32 NumNodes() const { return NodeCell.Num(); }
+
+	FORCEINLINE int32 ClusterOf(int32 X, int32 Y, int32 Z) const
+	{
+		return X / ClusterSize +
+			   (Y / ClusterSize) * NumClusters.X +
+			   (Z / ClusterSize) * NumClusters.X * NumClusters.Y;
+	}
+
+	FMGDNGridBounds ClusterBounds(int32 Cluster) const
+	{
+		const int32 CX = Cluster % NumClusters.X;
+		const int32 CY = (Cluster / NumClusters.X) % NumClusters.Y;
+		const int32 CZ = Cluster / (NumClusters.X * NumClusters.Y);
+
+		FMGDNGridBounds B;
+		B.Min = FIntVector(CX * ClusterSize, CY * ClusterSize, CZ * ClusterSize);
+		B.Max = FIntVector(
+			FMath::Min(B.Min.X + ClusterSize, GridSize.X) - 1,
+			FMath::Min(B.Min.Y + ClusterSize, GridSize.Y) - 1,
+			FMath::Min(B.Min.Z + ClusterSize, GridSize.Z) - 1);
+		return B;
+	}
+};
@@ -4,6 +4,74 @@
 #include "Engine/DataAsset.h"
 #include "MGDNNavDataAsset.generated.h"
 
+/** Order in which grid cells are stored, shared by the baked asset and the runtime grid. */
+UENUM(BlueprintType)
+enum class EMGDNCellLayout : uint8
+{
+	/** X rows, then Y, then Z layers. */
+	Linear,
+
+	/** 4x4x4 bricks of 64 cells, bricks in X, Y, Z order. Each axis is padded up to whole bricks. */
+	Brick,
+};
+
+namespace MGDNCellLayout
+{
+	FORCEINLINE int32 BricksAlong(int32 Cells)
+	{
+		return (Cells + 3) >> 2;
+	}
+
+	FORCEINLINE int32 NumIndices(EMGDNCellLayout Layout, int32 GX, int32 GY, int32 GZ)
+	{
+		if (Layout == EMGDNCellLayout::Brick)
+			return BricksAlong(GX) * BricksAlong(GY) * BricksAlong(GZ) * 64;
+
+		return GX * GY * GZ;
+	}
+
+	FORCEINLINE int32 ToIndex(EMGDNCellLayout Layout, int32 GX, int32 GY, int32 X, int32 Y, int32 Z)
+	{
+		if (Layout == EMGDNCellLayout::Brick)
+		{
+			const int32 BX = BricksAlong(GX);
+			const int32 Brick = (X >> 2) + ((Y >> 2) + (Z >> 2) * BricksAlong(GY)) * BX;
+
+			return (Brick << 6) | (X & 3) | ((Y & 3) << 2) | ((Z & 3) << 4);
+		}
+
+		return X + Y * GX + Z * (GX * GY);
+	}
+
+	FORCEINLINE void ToXYZ(EMGDNCellLayout Layout, int32 GX, int32 GY, int32 Index, int32& X, int32& Y, int32& Z)
+	{
+		if (Layout == EMGDNCellLayout::Brick)
+		{
+			const int32 BX  = BricksAlong(GX);
+			const int32 BXY = BX * BricksAlong(GY);
+
+			const int32 Brick = Index >> 6;
+			const int32 BZ = Brick / BXY;
+			const int32 BY = (Brick - BZ * BXY) / BX;
+
+			X = ((Brick - BZ * BXY - BY * BX) << 2) | (Index & 3);
+			Y = (BY << 2) | ((Index >> 2) & 3);
+			Z = (BZ << 2) | ((Index >> 4) & 3);
+			return;
+		}
+
+		const int32 XYCount = GX * GY;
+
+		Z = Index / XYCount;
+
+		const int32 Remainder = Index % XYCount;
+
+		Y = Remainder / GX;
+
+		X = Remainder % GX;
+	}
+}
+
 USTRUCT(BlueprintType)
 struct FMGDNGridNode
 {
@@ -30,6 +98,23 @@ struct FMGDNGridNode
 };
 
 
+/** Run of stored cells in one XY column of a sparse asset. */
+USTRUCT()
+struct FMGDNColumnSpan
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int16 MinZ = 0;
+
+	UPROPERTY()
+	int16 NumCells = 0;
+
+	// Entry of the MinZ cell in SpanNodes
+	UPROPERTY()
+	int32 FirstNode = 0;
+};
+
 UCLASS(BlueprintType)
 class MGDYNAMICNAVIGATION_API UMGDNNavDataAsset : public UDataAsset
 {
@@ -55,12 +140,67 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="MGDN")
 	FVector HalfSize = FVector::ZeroVector;
 
+	// Cell order of Nodes, assets baked before layouts existed are Linear
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="MGDN")
+	EMGDNCellLayout Layout = EMGDNCellLayout::Linear;
+
+	// Cell (0,0,0) sits this many cells into the volume box, the bake crops empty borders
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="MGDN")
-	TArray<FMGDNGridNode> Nodes; // size = GridX*GridY*GridZ
+	FIntVector CellOffset = FIntVector::ZeroValue;
+
+	// Largest capsule radius and full height this grid was baked for, zero when baked for any agent
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="MGDN|Agents")
+	float AgentRadius = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="MGDN|Agents")
+	float AgentHeight = 0.f;
+
+	// Grids of the same volume baked for other agent sizes, sub-objects of this asset. See UMGDNNavVolumeComponent::AgentLayers.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="MGDN|Agents")
+	TArray<UMGDNNavDataAsset*> AgentLayers;
+
+	// Dense storage, empty when the asset stores spans
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="MGDN")
+	TArray<FMGDNGridNode> Nodes; // size = NumIndices(), padding cells are never walkable
+
+	// Sparse storage: spans of ColumnSpans[C]..ColumnSpans[C+1] cover column C = X + Y*GridX
+	UPROPERTY()
+	TArray<int32> ColumnSpans;
+
+	UPROPERTY()
+	TArray<FMGDNColumnSpan> Spans;
+
+	// Walkable cells of all spans, in span order
+	UPROPERTY()
+	TArray<FMGDNGridNode> SpanNodes;
+
+	FORCEINLINE bool IsSparse() const { return ColumnSpans.Num() > 0; }
+
+	/** Stored cell at X,Y,Z in either storage, nullptr for air in sparse assets and cells outside the grid. */
+	const FMGDNGridNode* FindNode(int32 X, int32 Y, int32 Z) const;
+
+	/** Replaces the cells with span storage of the walkable cells of a dense GridX*GridY*GridZ array in X, Y, Z order. */
+	void SetSpansFromDense(const TArray<FMGDNGridNode>& DenseNodes);
+
+	/** Replaces the cells with dense Nodes in this asset's Layout, from the same input as SetSpansFromDense. */
+	void SetNodesFromDense(const TArray<FMGDNGridNode>& DenseNodes);
+
+	int32 CountWalkable() const;
+
+	/** True when an agent of this radius and full height fits the size this grid was baked for. */
+	FORCEINLINE bool FitsAgent(float Radius, float Height) const
+	{
+		return Radius <= AgentRadius && Height <= AgentHeight;
+	}
+
+	FORCEINLINE int32 NumIndices() const
+	{
+		return MGDNCellLayout::NumIndices(Layout, GridX, GridY, GridZ);
+	}
 
 	FORCEINLINE int32 Index(int32 X, int32 Y, int32 Z) const
 	{
-		return X + Y * GridX + Z * (GridX * GridY);
+		return MGDNCellLayout::ToIndex(Layout, GridX, GridY, X, Y, Z);
 	}
 
 	FORCEINLINE bool IsValid(int32 X, int32 Y, int32 Z) const
@@ -2,11 +2,33 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Components/BoxComponent.h"
+#include "MGDNRuntimeNavMesh.h"
 #include "MGDNNavVolumeComponent.generated.h"
 
 class UMGDNNavDataAsset;
 class UMGDNRuntimeNavMesh;
 
+/** An extra grid baked for agents up to a given size, see UMGDNNavVolumeComponent::AgentLayers. */
+USTRUCT(BlueprintType)
+struct FMGDNAgentLayerSettings
+{
+	GENERATED_BODY()
+
+	// Largest capsule radius that may use this layer
+	UPROPERTY(EditAnywhere, Category="MGDN", meta=(ClampMin="1"))
+	float AgentRadius = 40.f;
+
+	// Largest capsule full height that may use this layer, cells without this much headroom are not walkable
+	UPROPERTY(EditAnywhere, Category="MGDN", meta=(ClampMin="1"))
+	float AgentHeight = 180.f;
+
+	UPROPERTY(EditAnywhere, Category="MGDN", meta=(ClampMin="1"))
+	float CellSize = 100.f;
+
+	UPROPERTY(EditAnywhere, Category="MGDN", meta=(ClampMin="1"))
+	float CellHeight = 300.f;
+};
+
 UCLASS(ClassGroup=(Navigation), meta=(BlueprintSpawnableComponent))
 class MGDYNAMICNAVIGATION_API UMGDNNavVolumeComponent : public UBoxComponent
 {
@@ -21,21 +43,118 @@ public:
 	UPROPERTY(Transient)
 	UMGDNRuntimeNavMesh* RuntimeNav = nullptr;
 
+	// Runtime grids of SourceAsset->AgentLayers, same order
+	UPROPERTY(Transient)
+	TArray<UMGDNRuntimeNavMesh*> LayerNavs;
+
 	UPROPERTY(EditAnywhere, Category="MGDN|Grid")
 	float CellSize = 200.f;
 
 	UPROPERTY(EditAnywhere, Category="MGDN|Grid")
 	float CellHeight = 300.f;
 
+	// Largest floor height change between neighbouring cells an agent can step. Ramps also allow their slope.
+	UPROPERTY(EditAnywhere, Category="MGDN|Grid", meta=(ClampMin="0"))
+	float MaxStepHeight = 45.f;
+
+	// Walkable hits with a normal Z below this are baked as ramp cells, which may link decks
+	UPROPERTY(EditAnywhere, Category="MGDN|Grid", meta=(ClampMin="0", ClampMax="1"))
+	float RampNormalZ = 0.985f;
+
+	// Cell order written by BakeNow, the runtime grid follows the baked asset
+	UPROPERTY(EditAnywhere, Category="MGDN|Grid")
+	EMGDNCellLayout CellLayout = EMGDNCellLayout::Linear;
+
+	// Shrink the baked grid to the box around walkable cells, the volume itself keeps its size
+	UPROPERTY(EditAnywhere, Category="MGDN|Grid")
+	bool bCropToWalkable = true;
+
+	// Bake only walkable cells as Z spans per column instead of every cell of the grid
+	UPROPERTY(EditAnywhere, Category="MGDN|Grid")
+	bool bSparseStorage = true;
+
+	// Grids baked next to the main one for other agent sizes, e.g. a fine grid for drones and a coarse one for mechs.
+	// Agents search the layer baked closest to their capsule, the main grid when none fits.
+	UPROPERTY(EditAnywhere, Category="MGDN|Agents")
+	TArray<FMGDNAgentLayerSettings> AgentLayers;
+
+	// Search used for paths on this volume unless a query asks for another one
+	UPROPERTY(EditAnywhere, Category="MGDN|Search")
+	EMGDNSearchMode SearchMode = EMGDNSearchMode::AStar;
+
+	// Cluster edge length in cells for Hierarchical search. Larger clusters mean fewer entrances but more work refining each one.
+	UPROPERTY(EditAnywhere, Category="MGDN|Search", meta=(ClampMin="4", EditCondition="SearchMode==EMGDNSearchMode::Hierarchical"))
+	int32 ClusterSize = 16;
+
+	// Landmark cells picked on load for the ALT heuristic, which sees detours around bulkheads that the straight line
+	// distance misses. Each one costs a float per walkable cell of every grid. 0 turns it off.
+	UPROPERTY(EditAnywhere, Category="MGDN|Search", meta=(ClampMin="0", ClampMax="32"))
+	int32 NumLandmarks = 0;
+
 	UFUNCTION(CallInEditor, Category="MGDN")
 	void BakeNow();
 
 	UFUNCTION(CallInEditor, Category="MGDN")
 	void VisualizeGrid();
 
+	/** Runtime grid for a capsule: the fitting layer baked for the smallest radius, then height, RuntimeNav when it fits none. */
+	UMGDNRuntimeNavMesh* GetRuntimeNavFor(float AgentRadius, float AgentHeight) const;
+
+	/**
+	 * Blocks the cells a box overlaps on every grid of this volume until RemoveObstacle, see UMGDNRuntimeNavMesh::SetObstacle.
+	 * LocalTransform places the box centre relative to the owning actor, Extent is its half size. Returns the obstacle id.
+	 */
+	UFUNCTION(BlueprintCallable, Category="MGDN")
+	int32 AddObstacle(const FTransform& LocalTransform, const FVector& Extent);
+
+	/** Moves or resizes an obstacle, only cells entering or leaving it change. */
+	UFUNCTION(BlueprintCallable, Category="MGDN")
+	void MoveObstacle(int32 ObstacleId, const FTransform& LocalTransform, const FVector& Extent);
+
+	UFUNCTION(BlueprintCallable, Category="MGDN")
+	void RemoveObstacle(int32 ObstacleId);
+
+	/** True while obstacle changes wait for worker searches on this volume's grids, see ApplyQueuedObstacles. */
+	bool HasQueuedObstacles() const { return QueuedObstacles.Num() > 0; }
+
+	/** Applies queued obstacle changes that no worker search on this volume's grids would read. Called every tick by the subsystem. */
+	void ApplyQueuedObstacles();
+
+	// Number of random start/goal pairs BenchmarkPaths runs. Pairs come from a fixed seed so runs are comparable.
+	UPROPERTY(EditAnywhere, Category="MGDN|Debug", meta=(ClampMin="1"))
+	int32 BenchmarkQueryCount = 200;
+
+	/** Runs grid searches between random walkable cells and logs queries and expansions per second. */
+	UFUNCTION(CallInEditor, Category="MGDN")
+	void BenchmarkPaths();
+
 protected:
 	virtual void OnRegister() override;
 	virtual void OnUnregister() override;
 
 private:
+
+	// Creates RuntimeNav and LayerNavs if needed and rebuilds them from SourceAsset with this volume's settings
+	bool BuildRuntimeNav();
+
+	// Traces one grid of the volume into Target, AgentHeight above zero also checks headroom for that agent
+	bool BakeGrid(UMGDNNavDataAsset* Target, float InCellSize, float InCellHeight, float AgentRadius, float AgentHeight);
+
+	// Sets or removes obstacle Id on RuntimeNav and every layer, queued while it would change cells under worker searches
+	void ApplyObstacle(int32 ObstacleId, const FTransform* LocalTransform, const FVector& Extent);
+
+	struct FMGDNQueuedObstacle
+	{
+		bool bRemove = false;
+		FTransform LocalTransform;
+		FVector Extent = FVector::ZeroVector;
+	};
+
+	// True when Change opens or closes cells of any grid of this volume
+	bool ChangesCells(int32 ObstacleId, const FMGDNQueuedObstacle& Change) const;
+
+	// Latest change of each obstacle not applied yet
+	TMap<int32, FMGDNQueuedObstacle> QueuedObstacles;
+
+	int32 NextObstacleId = 0;
 };
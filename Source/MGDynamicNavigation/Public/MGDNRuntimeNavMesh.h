@@ -2,9 +2,287 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "UObject/Object.h"
+#include "Containers/LruCache.h"
+#include "MGDNClusterGraph.h"
+#include "MGDNNavDataAsset.h"
+#include "MGDNWalkableBits.h"
+#include <atomic>
 #include "MGDNRuntimeNavMesh.generated.h"
 
-class UMGDNNavDataAsset;
+struct FMGDNSearchState;
+struct FMGDNCellRecord;
+
+UENUM(BlueprintType)
+enum class EMGDNSearchMode : uint8
+{
+	/** Use the search mode configured on the nav volume. */
+	Default,
+
+	/** A* over every walkable neighbour. */
+	AStar,
+
+	/** Jump Point Search. Prunes symmetric paths on each deck layer, same path lengths as A*. */
+	JumpPoint,
+
+	/** Hierarchical A* over cluster entrances, refined only inside the clusters on the path. Near optimal. */
+	Hierarchical,
+
+	/** A* from both ends at once, meeting in the middle. Fewer expansions on long corridor queries. */
+	Bidirectional,
+};
+
+/** Moves an A* query may take out of a cell, see FMGDNPathQuery::MoveSet. */
+UENUM(BlueprintType)
+enum class EMGDNMoveSet : uint8
+{
+	/** Straight moves along the grid axes only. */
+	Faces6,
+
+	/** Straight moves and diagonals within one axis plane. */
+	Edges18,
+
+	/** Every baked move, diagonals across cell corners included. */
+	Corners26,
+};
+
+/** How an A* query prices a move, see FMGDNPathQuery::StepCost. */
+UENUM(BlueprintType)
+enum class EMGDNStepCost : uint8
+{
+	/** A move costs its length, sqrt 2 or sqrt 3 for diagonals. */
+	Octile,
+
+	/** Every move costs one, the path with the fewest moves wins. */
+	Unit,
+};
+
+/** Per query options for UMGDNRuntimeNavMesh::FindPath. */
+USTRUCT(BlueprintType)
+struct FMGDNPathQuery
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="MGDN")
+	EMGDNSearchMode SearchMode = EMGDNSearchMode::Default;
+
+	// Drop waypoints the path can skip in a straight line over walkable cells, see UMGDNRuntimeNavMesh::SmoothIndexPath
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="MGDN")
+	bool bSmoothPath = true;
+
+	// Weighted A*: above 1 the heuristic counts this much more, paths may be up to this factor longer than the
+	// shortest in exchange for far fewer expansions. Used by AStar and JumpPoint searches.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="MGDN", meta=(ClampMin="1"))
+	float HeuristicWeight = 1.f;
+
+	// Radius of the agent the path is for. Paths only enter cells with at least this much Clearance, apart from
+	// their start and end cells. Radii above half a cell search cell by cell, JumpPoint and Hierarchical run as A* then.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="MGDN", meta=(ClampMin="0"))
+	float AgentRadius = 0.f;
+
+	// Moves the search may take. Anything but every move at its length runs as A*, each combination of MoveSet,
+	// StepCost and cell costs on its own compiled kernel.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="MGDN")
+	EMGDNMoveSet MoveSet = EMGDNMoveSet::Corners26;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="MGDN")
+	EMGDNStepCost StepCost = EMGDNStepCost::Octile;
+
+	// Scale moves by the costs of the cells they enter, see UMGDNRuntimeNavMesh::SetCellCosts
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="MGDN")
+	bool bUseCellCosts = true;
+};
+
+/** Counters filled by a grid search, used for profiling and benchmarks. */
+struct FMGDNSearchStats
+{
+	// Cells taken from the open list and expanded
+	int32 Expansions = 0;
+
+	// Cells pushed to or re-prioritized in the open list
+	int32 Pushes = 0;
+
+	FMGDNSearchStats& operator+=(const FMGDNSearchStats& Other)
+	{
+		Expansions += Other.Expansions;
+		Pushes     += Other.Pushes;
+		return *this;
+	}
+};
+
+/**
+ * A* query run a budget of expansions at a time, see UMGDNRuntimeNavMesh::BeginSlicedSearch.
+ * Holds its search records from the first slice until it is done. A rebuild of the nav it started on ends it without a path.
+ */
+struct MGDYNAMICNAVIGATION_API FMGDNSlicedSearch
+{
+	FMGDNSlicedSearch() = default;
+	~FMGDNSlicedSearch();
+
+	UE_NONCOPYABLE(FMGDNSlicedSearch);
+
+	int32 Start = INDEX_NONE;
+	int32 End = INDEX_NONE;
+
+	// Set once the search found End or ran out of cells
+	bool bDone = false;
+	bool bFound = false;
+
+	// Cell path from Start to End once found
+	TArray<int32> Path;
+
+	// Summed over all slices
+	FMGDNSearchStats Stats;
+
+	// See FMGDNPathQuery::HeuristicWeight
+	float HeuristicWeight = 1.f;
+
+	// See FMGDNPathQuery::AgentRadius
+	float AgentRadius = 0.f;
+
+	// See FMGDNPathQuery::MoveSet, StepCost and bUseCellCosts
+	EMGDNMoveSet MoveSet = EMGDNMoveSet::Corners26;
+	EMGDNStepCost StepCost = EMGDNStepCost::Octile;
+	bool bUseCellCosts = true;
+
+	// UMGDNRuntimeNavMesh::GetGridVersion the search started at, its cells index that grid only
+	uint32 GridVersion = 0;
+
+	/** Drops the query and returns its records to the search state pool. */
+	void Reset();
+
+private:
+
+	friend class UMGDNRuntimeNavMesh;
+
+	FMGDNSearchState* State = nullptr;
+};
+
+/**
+ * First move towards one goal cell from every cell that can reach it, see UMGDNRuntimeNavMesh::GetFlowField.
+ * Shared by every agent heading to that goal, it lives as long as one of them holds it.
+ */
+struct FMGDNFlowField
+{
+	static constexpr uint8 NoMove = 0xFF;
+
+	int32 Goal = INDEX_NONE;
+
+	// Clearance the field was built for, see FMGDNPathQuery::AgentRadius
+	float MinClearance = 0.f;
+
+	// UMGDNRuntimeNavMesh::GetNavVersion the field was built at
+	uint32 NavVersion = 0;
+
+	// FMGDNWalkableBits::NeighborMask bit to take from each walkable cell, stored at Walkable.Rank(Index).
+	// NoMove on Goal and on cells that cannot reach it.
+	TArray<uint8> Moves;
+};
+
+/**
+ * Path to one goal cell kept up to date while cells are blocked and unblocked, see UMGDNRuntimeNavMesh::BeginIncrementalPath.
+ * Holds its search records and one cost per cell between plans, the nav it started on must outlive it.
+ * Paths of UMGDNRuntimeNavMesh::FollowIncrementalPath search from the agent, Goal is the agent's cell and Start the target's.
+ */
+struct MGDYNAMICNAVIGATION_API FMGDNIncrementalPath
+{
+	FMGDNIncrementalPath() = default;
+	~FMGDNIncrementalPath();
+
+	UE_NONCOPYABLE(FMGDNIncrementalPath);
+
+	int32 Start = INDEX_NONE;
+	int32 Goal = INDEX_NONE;
+
+	// See FMGDNPathQuery::AgentRadius
+	float AgentRadius = 0.f;
+
+	// Cell path from Start to Goal as of the last plan, empty when there was none
+	TArray<int32> Path;
+
+	// Work of the last plan only
+	FMGDNSearchStats Stats;
+
+	/** Drops the search and returns its records to the search state pool. */
+	void Reset();
+
+private:
+
+	friend class UMGDNRuntimeNavMesh;
+
+	// Record of Cell, resetting its Rhs along with it when it belongs to an older search
+	FMGDNCellRecord& Visit(int32 Cell);
+
+	FMGDNSearchState* State = nullptr;
+
+	// One step lookahead cost to Goal of each visited cell, records hold the settled cost in G
+	TArray<float> Rhs;
+
+	// Start the queued keys were computed for, and the heuristic drift of earlier starts added to every key since
+	int32 KeyStart = INDEX_NONE;
+	float KeyOffset = 0.f;
+
+	// Per cell scratch of RerootIncrementalPath, all zero between calls
+	TArray<uint8> Marks;
+
+	// Nav version the records match
+	uint32 NavVersion = 0;
+
+	float MinClearance = 0.f;
+};
+
+/** Box that blocks the cells it overlaps at runtime, see UMGDNRuntimeNavMesh::SetObstacle. */
+struct FMGDNObstacle
+{
+	// Centre and rotation of the box in platform local space, scale is ignored
+	FTransform LocalTransform;
+
+	// Half size along the box's own axes
+	FVector Extent = FVector::ZeroVector;
+
+	// Cells the box holds a reference on, ascending
+	TArray<int32> Cells;
+};
+
+/** Resolved cells and options of a FindPath query, see UMGDNRuntimeNavMesh::PathCacheSize. */
+struct FMGDNPathCacheKey
+{
+	int32 Start = INDEX_NONE;
+	int32 End = INDEX_NONE;
+	EMGDNSearchMode SearchMode = EMGDNSearchMode::AStar;
+	bool bSmoothPath = false;
+	float HeuristicWeight = 1.f;
+	float MinClearance = 0.f;
+	EMGDNMoveSet MoveSet = EMGDNMoveSet::Corners26;
+	EMGDNStepCost StepCost = EMGDNStepCost::Octile;
+	bool bCellCosts = false;
+
+	bool operator==(const FMGDNPathCacheKey& Other) const
+	{
+		return Start == Other.Start && End == Other.End && SearchMode == Other.SearchMode &&
+			   bSmoothPath == Other.bSmoothPath && HeuristicWeight == Other.HeuristicWeight &&
+			   MinClearance == Other.MinClearance && MoveSet == Other.MoveSet && StepCost == Other.StepCost &&
+			   bCellCosts == Other.bCellCosts;
+	}
+
+	friend uint32 GetTypeHash(const FMGDNPathCacheKey& Key)
+	{
+		uint32 Hash = HashCombineFast(GetTypeHash(Key.Start), GetTypeHash(Key.End));
+		Hash = HashCombineFast(Hash, GetTypeHash(uint8(Key.SearchMode) | (Key.bSmoothPath ? 0x80 : 0)));
+		Hash = HashCombineFast(Hash, GetTypeHash(uint8(Key.MoveSet) | uint8(Key.StepCost) << 2 | (Key.bCellCosts ? 0x80 : 0)));
+		Hash = HashCombineFast(Hash, GetTypeHash(Key.HeuristicWeight));
+		return HashCombineFast(Hash, GetTypeHash(Key.MinClearance));
+	}
+};
+
+/** Lookups of the FindPath cache, see UMGDNRuntimeNavMesh::GetPathCacheStats. */
+struct FMGDNPathCacheStats
+{
+	int64 Hits = 0;
+	int64 Misses = 0;
+
+	// Paths held right now
+	int32 Entries = 0;
+};
 
 UCLASS()
 class MGDYNAMICNAVIGATION_API UMGDNRuntimeNavMesh : public UObject
@@ -21,7 +299,61 @@ public:
 	float CellHeight = 100.f;
 	FVector HalfSize = FVector::ZeroVector;
 
-	TArray<uint8> Walkable;
+	// First grid cell inside the volume box, see UMGDNNavDataAsset::CellOffset
+	FIntVector CellOffset = FIntVector::ZeroValue;
+
+	// Cell order of every per cell array, taken from the asset
+	EMGDNCellLayout Layout = EMGDNCellLayout::Linear;
+
+	FMGDNWalkableBits Walkable;
+
+	// Allowed moves of each walkable cell as FMGDNWalkableBits::NeighborMask bits, stored at Walkable.Rank(Index)
+	TArray<uint32> Connectivity;
+
+	// Connected region of each walkable cell, stored at Walkable.Rank(Index). Cells with different labels cannot reach each other.
+	// Relabeled by the first GetComponent after SetCellsBlocked, so read it through GetComponent.
+	mutable TArray<int32> Components;
+
+	mutable int32 NumComponents = 0;
+
+	// Distance from each walkable cell's centre to the nearest blocked cell or grid edge in its own layer,
+	// in world units and at least half a cell. Stored at Walkable.Rank(Index).
+	TArray<float> Clearance;
+
+	// Closest walkable cell to every cell by world distance, the cell itself when walkable, INDEX_NONE without any walkable cell
+	TArray<int32> NearestWalkable;
+
+	// Highest floor height change a move may make, ramp cells also allow their run length on top. Set before BuildFromAsset.
+	float MaxStepHeight = 45.f;
+
+	// Search used by queries that leave their mode on Default. Set before BuildFromAsset,
+	// acceleration data for this mode is built with the grid.
+	EMGDNSearchMode DefaultSearchMode = EMGDNSearchMode::AStar;
+
+	// JPS+ distances for the four straight in-plane directions, 4 entries per cell.
+	// >0 steps to the next jump point, <=0 minus the steps to the last open cell before a wall.
+	// Empty unless the grid was built with JumpPoint as default, jumps scan the grid then.
+	TArray<int16> JumpDistances;
+
+	// Cells JPS always stops on and expands fully, deck changes and cells next to height-blocked moves
+	FMGDNWalkableBits JumpStops;
+
+	// Edge length in cells of the clusters used by hierarchical search
+	int32 ClusterSize = 16;
+
+	// Built when Hierarchical is the default mode, hierarchical queries fall back to A* otherwise
+	FMGDNClusterGraph ClusterGraph;
+
+	// FindPath results kept for repeated queries between the same cells, least recently used go first. 0 turns
+	// the cache off. Set before BuildFromAsset.
+	int32 PathCacheSize = 256;
+
+	// Landmark cells the ALT heuristic measures from, 0 turns it off. More landmarks tighten the bound around walls
+	// and bulkheads but cost a float per walkable cell each. Set before BuildFromAsset.
+	int32 NumLandmarks = 0;
+
+	// Cells picked as landmarks by the last BuildFromAsset, all in the largest connected region
+	TArray<int32> Landmarks;
 
 	bool BuildFromAsset(const UMGDNNavDataAsset* Asset);
 
@@ -29,9 +361,230 @@ public:
 		const FTransform& PlatformTransform,
 		const FVector& StartWorld,
 		const FVector& EndWorld,
-		TArray<FVector>& OutWorldPath
+		TArray<FVector>& OutWorldPath,
+		const FMGDNPathQuery& Query = FMGDNPathQuery()
+	) const;
+
+	/** Runs the grid search between two walkable cell indices. */
+	bool FindIndexPath(int32 StartIndex, int32 EndIndex, TArray<int32>& OutIndices,
+	                   const FMGDNPathQuery& Query = FMGDNPathQuery(),
+	                   FMGDNSearchStats* OutStats = nullptr) const;
+
+	/**
+	 * True when Query takes every move at its length and no cell cost applies to it. Jump tables, clusters, flow fields
+	 * and D* Lite only know these moves, other queries run as A*.
+	 */
+	bool HasDefaultMoves(const FMGDNPathQuery& Query) const;
+
+	/**
+	 * Searches from StartIndex towards all of GoalIndices at once and stops at the first goal it reaches, the one with
+	 * the shortest path. OutGoal is that goal's position in GoalIndices, INDEX_NONE without a path. Goals that are not
+	 * open or cannot be reached from the start are skipped. Always A*, Query.SearchMode is ignored, and with a
+	 * HeuristicWeight above 1 the winner's path is within that factor of the nearest goal's. MoveSet, StepCost and
+	 * cell costs are honoured, unit steps run as Dijkstra.
+	 */
+	bool FindNearestGoalPath(int32 StartIndex, TConstArrayView<int32> GoalIndices, TArray<int32>& OutIndices, int32& OutGoal,
+	                         const FMGDNPathQuery& Query = FMGDNPathQuery(), FMGDNSearchStats* OutStats = nullptr) const;
+
+	/** FindPath to whichever of GoalsWorld has the shortest path, OutGoal is its position in GoalsWorld. See FindNearestGoalPath. */
+	bool FindNearestPath(
+		const FTransform& PlatformTransform,
+		const FVector& StartWorld,
+		TConstArrayView<FVector> GoalsWorld,
+		TArray<FVector>& OutWorldPath,
+		int32& OutGoal,
+		const FMGDNPathQuery& Query = FMGDNPathQuery()
+	) const;
+
+	/** Maps world points to walkable start and end cells, using a nearby walkable cell when a point's own cell is blocked. */
+	bool ResolvePathCells(const FTransform& PlatformTransform, const FVector& StartWorld, const FVector& EndWorld,
+	                      int32& OutStartIndex, int32& OutEndIndex) const;
+
+	/**
+	 * True when the straight line between the centres of two cells only crosses cells it could walk through move by move.
+	 * With an AgentRadius every crossed cell after From also needs that much Clearance, see FMGDNPathQuery::AgentRadius.
+	 */
+	bool HasLineOfSight(int32 From, int32 To, float AgentRadius = 0.f) const;
+
+	/**
+	 * HasLineOfSight for agents searching with Query: every step of the line is a move of Query.MoveSet, and while cell
+	 * costs apply to it the line enters no cell costing more than 1 before To.
+	 */
+	bool HasLineOfSight(int32 From, int32 To, const FMGDNPathQuery& Query) const;
+
+	/** String pulls a cell path, keeping only the cells where the line of sight from the last kept cell breaks. */
+	void SmoothIndexPath(TArray<int32>& InOutIndices, float AgentRadius = 0.f) const;
+
+	/** SmoothIndexPath along the line of sight of Query, for paths searched with it. */
+	void SmoothIndexPath(TArray<int32>& InOutIndices, const FMGDNPathQuery& Query) const;
+
+	/** Writes the world space centres of the cells of IndexPath. */
+	void IndexPathToWorld(const FTransform& PlatformTransform, const TArray<int32>& IndexPath,
+	                      TArray<FVector>& OutWorldPath) const;
+
+	/** Centre of a cell in platform local space. */
+	FVector GetCellCenterLocal(int32 Index) const;
+
+	/**
+	 * Starts an A* query between two cells that StepSlicedSearch advances, Query.SearchMode is ignored.
+	 * Records are only borrowed on the first step, so queued searches cost no memory.
+	 * Returns false, with Search already done, when either cell is not walkable.
+	 */
+	bool BeginSlicedSearch(int32 StartIndex, int32 EndIndex, FMGDNSlicedSearch& Search,
+	                       const FMGDNPathQuery& Query = FMGDNPathQuery()) const;
+
+	/** Expands up to MaxExpansions cells of Search. Returns true once Search is done, a search the grid was rebuilt under is done and not found. */
+	bool StepSlicedSearch(FMGDNSlicedSearch& Search, int32 MaxExpansions) const;
+
+	/**
+	 * World path of a found sliced search, smoothed when Query asks for it. False when Search found nothing or the grid
+	 * was rebuilt since it started, resolve searches before rebuilding to keep their paths.
+	 */
+	bool ResolveSlicedPath(const FMGDNSlicedSearch& Search, const FTransform& PlatformTransform, const FMGDNPathQuery& Query,
+	                       TArray<FVector>& OutWorldPath) const;
+
+	/**
+	 * Flow field towards a walkable goal cell for agents of AgentRadius, built with one search over the goal's region.
+	 * Calls for the same goal and clearance share one field for as long as any caller keeps it. Thread safe.
+	 * Fields take every move at its length and ignore cell costs, see HasDefaultMoves.
+	 */
+	TSharedPtr<const FMGDNFlowField> GetFlowField(int32 GoalIndex, float AgentRadius = 0.f) const;
+
+	/** Cell path from StartIndex to the goal of Field along its moves. False when StartIndex cannot reach the goal. */
+	bool FollowFlowField(const FMGDNFlowField& Field, int32 StartIndex, TArray<int32>& OutIndices) const;
+
+	/**
+	 * FindPath that follows the flow field of the end cell instead of searching. InOutField is reused when it leads there already.
+	 * Queries without HasDefaultMoves run FindPath and reset InOutField.
+	 */
+	bool FindFlowPath(
+		const FTransform& PlatformTransform,
+		const FVector& StartWorld,
+		const FVector& EndWorld,
+		TArray<FVector>& OutWorldPath,
+		TSharedPtr<const FMGDNFlowField>& InOutField,
+		const FMGDNPathQuery& Query = FMGDNPathQuery()
 	) const;
 
+	/**
+	 * Plans Path from StartIndex to GoalIndex for agents of AgentRadius with a D* Lite search that
+	 * ReplanIncrementalPath repairs later. Returns false, with Path.Path empty, when there is no path right now.
+	 * Every move at its length without cell costs, queries without HasDefaultMoves need FindIndexPath.
+	 */
+	bool BeginIncrementalPath(int32 StartIndex, int32 GoalIndex, FMGDNIncrementalPath& Path, float AgentRadius = 0.f) const;
+
+	/**
+	 * Brings Path up to date with the cells blocked or unblocked since its last plan and an agent now at StartIndex.
+	 * Only cells whose cost to the goal changed are searched again. Starts over after a rebuild.
+	 */
+	bool ReplanIncrementalPath(FMGDNIncrementalPath& Path, int32 StartIndex) const;
+
+	/**
+	 * Plans Path from an agent at AgentIndex to a target at TargetIndex that keeps moving, and on later calls repairs it
+	 * as either end moves or cells are blocked or reopened, Moving Target D* Lite. The search is rooted behind the agent, so
+	 * a moving target only shifts keys and walking along the path costs nothing. An agent leaving the path moves the root,
+	 * keeping the costs of every cell whose shortest route passes it.
+	 * Path.Path runs from the agent to the target. Starts over after a rebuild or when AgentRadius changes.
+	 */
+	bool FollowIncrementalPath(FMGDNIncrementalPath& Path, int32 AgentIndex, int32 TargetIndex, float AgentRadius = 0.f) const;
+
+	EMGDNSearchMode ResolveSearchMode(EMGDNSearchMode Requested) const;
+
+	/** Counter bumped whenever the grid changes, cached paths of older versions are never used. */
+	FORCEINLINE uint32 GetNavVersion() const { return NavVersion; }
+
+	/** Counter bumped by every BuildFromAsset, cell indices taken at another version point into another grid. */
+	FORCEINLINE uint32 GetGridVersion() const { return GridVersion; }
+
+	/** Bumps the nav version and drops cached paths and flow fields. Call after changing walkability or moves outside BuildFromAsset. */
+	void MarkNavDataChanged();
+
+	/**
+	 * Adds obstacle Id as a box in platform local space, or moves it when it exists. Cells stay blocked while any obstacle
+	 * overlaps them, and a move only restamps the cells entering or leaving the box. Baked data is never modified,
+	 * obstacles are stamped again after BuildFromAsset. Changes the grid under running searches, call it on the game
+	 * thread once searches on this nav are done, see UMGDynamicNavigationSubsystem::WaitForPathRequests.
+	 * Returns true when any cell opened or closed.
+	 */
+	bool SetObstacle(int32 Id, const FTransform& LocalTransform, const FVector& Extent);
+
+	/** Removes obstacle Id and reopens the cells nothing else blocks. Same rules as SetObstacle. */
+	bool RemoveObstacle(int32 Id);
+
+	/** The obstacle registered as Id, nullptr when there is none. */
+	const FMGDNObstacle* FindObstacle(int32 Id) const { return Obstacles.Find(Id); }
+
+	/** Every obstacle registered on this nav by id. */
+	const TMap<int32, FMGDNObstacle>& GetObstacles() const { return Obstacles; }
+
+	/** Cells a box in platform local space overlaps, ascending. Read only, see SetObstacle. */
+	void GatherObstacleCells(const FTransform& LocalTransform, const FVector& Extent, TArray<int32>& OutCells) const;
+
+	/**
+	 * Scales the cost of every move into Cells by Cost, kept at 1 or more so path heuristics stay admissible, 1 restores them.
+	 * Read by A* queries with FMGDNPathQuery::bUseCellCosts, other search modes run as A* for them while any cost is set.
+	 * Only cached paths are dropped, NavVersion stays: flow fields and D* Lite never read costs, and moves under way
+	 * keep their paths until cells they cross change. Dropped by BuildFromAsset. Same threading rules as SetObstacle.
+	 */
+	void SetCellCosts(TConstArrayView<int32> Cells, float Cost);
+
+	/** Drops every cost set with SetCellCosts. */
+	void ClearCellCosts();
+
+	FORCEINLINE bool HasCellCosts() const { return CellCosts.Num() > 0; }
+
+	/** Move cost scale of a walkable cell, 1 unless set with SetCellCosts. */
+	FORCEINLINE float GetCellCost(int32 Index) const
+	{
+		return CellCosts.Num() > 0 ? CellCosts[Walkable.Rank(Index)] : 1.f;
+	}
+
+	/** True for walkable cells closed by an obstacle. */
+	FORCEINLINE bool IsCellBlocked(int32 Index) const
+	{
+		return NumBlockedCells > 0 && BlockedCells[Index];
+	}
+
+	/**
+	 * Adds the cells obstacles opened or closed after nav version Version to OutCells, a cell may show up more than once.
+	 * False when the log no longer reaches back that far or the grid was rebuilt since, plan from scratch then.
+	 */
+	bool GetCellChangesSince(uint32 Version, TArray<int32>& OutCells) const;
+
+	FMGDNPathCacheStats GetPathCacheStats() const;
+
+	/** Relabels Components from Connectivity. SetCellsBlocked leaves them to the next GetComponent. */
+	void BuildComponents() const;
+
+	/** Component label of a walkable cell, blocked cells are a region of their own. */
+	FORCEINLINE int32 GetComponent(int32 Index) const
+	{
+		if (bComponentsStale.load(std::memory_order_acquire))
+		{
+			RefreshComponents();
+		}
+
+		return Components[Walkable.Rank(Index)];
+	}
+
+	/** Clearance of a walkable cell. */
+	FORCEINLINE float GetClearance(int32 Index) const
+	{
+		return Clearance[Walkable.Rank(Index)];
+	}
+
+	/** True when a path between two walkable cells exists. */
+	FORCEINLINE bool AreConnected(int32 A, int32 B) const
+	{
+		return GetComponent(A) == GetComponent(B);
+	}
+
+	/** Size of the cell index space, larger than the cell count when the layout pads the grid. */
+	FORCEINLINE int32 NumCellIndices() const
+	{
+		return MGDNCellLayout::NumIndices(Layout, GridX, GridY, GridZ);
+	}
+
 private:
 
 	FORCEINLINE bool IsValid(int32 X, int32 Y, int32 Z) const
@@ -43,49 +596,301 @@ private:
 
 	FORCEINLINE int32 ToIndex(int32 X, int32 Y, int32 Z) const
 	{
-		return X + Y * GridX + Z * (GridX * GridY);
+		return MGDNCellLayout::ToIndex(Layout, GridX, GridY, X, Y, Z);
+	}
+
+	FORCEINLINE bool IsWalkable(int32 X, int32 Y, int32 Z) const
+	{
+		return IsValid(X, Y, Z) && Walkable[ToIndex(X, Y, Z)];
+	}
+
+	// Walkable and not blocked at runtime, the cells a path may start or end on
+	FORCEINLINE bool IsOpen(int32 Index) const
+	{
+		return Walkable[Index] && !IsCellBlocked(Index);
 	}
 
 	FORCEINLINE void ToXYZ(int32 Index, int32& X, int32& Y, int32& Z) const
 	{
-		const int32 XYCount = GridX * GridY;
+		MGDNCellLayout::ToXYZ(Layout, GridX, GridY, Index, X, Y, Z);
+	}
+	
+	// Nearest walkable cell to SX,SY,SZ at any distance, see NearestWalkable. With a PreferredComponent the
+	// nearest cell of that component within SearchRadius wins when the overall nearest one belongs to another.
+	int32 FindNearestWalkable(int32 SX, int32 SY, int32 SZ, int32 SearchRadius = 2, int32 PreferredComponent = INDEX_NONE) const;
 
-		Z = Index / XYCount;
+	// Fills NearestWalkable with a separable Euclidean distance transform over the grid
+	void BuildNearestWalkable();
 
-		const int32 Remainder = Index % XYCount;
+	// Fills Clearance with a distance transform of the blocked cells of each layer
+	void BuildClearance();
 
-		Y = Remainder / GridX;
+	// Clearance searches for AgentRadius have to check, 0 when every walkable cell has enough
+	FORCEINLINE float RequiredClearance(float AgentRadius) const
+	{
+		return AgentRadius > 0.5f * CellSize ? AgentRadius : 0.f;
+	}
 
-		X = Remainder % GridX;
+	// False for cells a search with MinClearance must not enter
+	FORCEINLINE bool HasClearance(int32 Index, float MinClearance) const
+	{
+		return MinClearance <= 0.f || GetClearance(Index) >= MinClearance;
 	}
-	
-	int32 FindNearestWalkable(int32 SX, int32 SY, int32 SZ, int32 SearchRadius = 2) const
+
+	// Index offset of each FMGDNWalkableBits::NeighborMask bit in the Linear layout
+	int32 NeighborOffsets[27] = {};
+
+	// Cell a move bit leads to, X/Y/Z are the coordinates of Index
+	FORCEINLINE int32 StepIndex(int32 Index, int32 X, int32 Y, int32 Z, int32 Bit) const
+	{
+		if (Layout == EMGDNCellLayout::Linear)
+			return Index + NeighborOffsets[Bit];
+
+		// Inside a brick a step is a local offset, leaving it moves one brick and wraps the local coordinate
+		const FIntVector D = FMGDNWalkableBits::BitDelta(Bit);
+		return Index +
+			BrickStep(X & 3, D.X, 1, BrickStrides.X) +
+			BrickStep(Y & 3, D.Y, 4, BrickStrides.Y) +
+			BrickStep(Z & 3, D.Z, 16, BrickStrides.Z);
+	}
+
+	static FORCEINLINE int32 BrickStep(int32 Local, int32 D, int32 LocalStride, int32 BrickStride)
+	{
+		const int32 Next = Local + D;
+		return (Next & ~3) == 0 ? D * LocalStride : D * (BrickStride - 3 * LocalStride);
+	}
+
+	// Index distance between neighbouring bricks along X, Y and Z in the Brick layout
+	FIntVector BrickStrides = FIntVector::ZeroValue;
+
+	// Sizes a per cell bitset for the current layout
+	void InitCellBits(FMGDNWalkableBits& Bits) const;
+
+	// Walkable cells of the 3x3x3 block around a cell, see FMGDNWalkableBits::NeighborMask
+	uint32 GatherWalkableNeighbors(int32 Index, int32 X, int32 Y, int32 Z) const;
+
+	// Moves out of a walkable cell, see Connectivity
+	FORCEINLINE uint32 GetMoveMask(int32 Index) const
 	{
-		for (int32 R = 0; R <= SearchRadius; R++)
+		return Connectivity[Walkable.Rank(Index)];
+	}
+
+	// Moves out of a walkable cell as baked, before any SetCellsBlocked
+	FORCEINLINE uint32 GetBakedMoveMask(int32 Index) const
+	{
+		const int32 Rank = Walkable.Rank(Index);
+		return BakedConnectivity.Num() > 0 ? BakedConnectivity[Rank] : Connectivity[Rank];
+	}
+
+	FORCEINLINE bool CanMove(int32 Index, int32 DX, int32 DY, int32 DZ) const
+	{
+		return (GetMoveMask(Index) >> FMGDNWalkableBits::BitOf(DX, DY, DZ)) & 1;
+	}
+
+	// Drops moves that leave Bounds from a cell inside it
+	static FORCEINLINE uint32 ClipMoves(uint32 Moves, int32 X, int32 Y, int32 Z, const FMGDNGridBounds& Bounds)
+	{
+		return Moves & ~FMGDNWalkableBits::ClipMask(
+			X == Bounds.Min.X, X == Bounds.Max.X,
+			Y == Bounds.Min.Y, Y == Bounds.Max.Y,
+			Z == Bounds.Min.Z, Z == Bounds.Max.Z);
+	}
+
+	void BuildConnectivity(const UMGDNNavDataAsset* Asset);
+
+	//Find Neighbours
+	void AddNeighbors26(int32 Index, TArray<int32>& Out, const FMGDNGridBounds* Bounds = nullptr) const;
+
+	// ExpandAStar compiled for one search policy
+	using FExpandAStarFn = bool (UMGDNRuntimeNavMesh::*)(FMGDNSearchState&, int32, float, float, int32,
+	                                                     const FMGDNGridBounds*, FMGDNSearchStats&, bool&) const;
+
+	// Kernel for a query's options, picked once per query so no move pays for the choice
+	static FExpandAStarFn SelectExpandAStar(EMGDNMoveSet MoveSet, EMGDNStepCost StepCost, bool bCellCosts, bool bClearance);
+
+	// Expand defaults to every move at its length without cell costs, the moves jump tables and clusters are built on
+	bool AStar(int32 Start, int32 End, TArray<int32>& OutIndices, FMGDNSearchStats* OutStats,
+	           const FMGDNGridBounds* Bounds = nullptr, float HeuristicWeight = 1.f, float MinClearance = 0.f,
+	           FExpandAStarFn Expand = nullptr) const;
+
+	// Length in cells of the move a NeighborMask bit stands for: 1 along an axis, sqrt 2 across an edge, sqrt 3 across a corner
+	static FORCEINLINE float MoveCost(int32 Bit)
+	{
+		static constexpr uint8 Axes[27] = { 3,2,3, 2,1,2, 3,2,3,  2,1,2, 1,0,1, 2,1,2,  3,2,3, 2,1,2, 3,2,3 };
+		static constexpr float Lengths[4] = { 0.f, 1.f, UE_SQRT_2, UE_SQRT_3 };
+		return Lengths[Axes[Bit]];
+	}
+
+	// Shortest move cost over an open grid between cells DX,DY,DZ apart, so never more than any real path
+	static FORCEINLINE float OctileDistance(int32 DX, int32 DY, int32 DZ)
+	{
+		int32 A = FMath::Abs(DX);
+		int32 B = FMath::Abs(DY);
+		int32 C = FMath::Abs(DZ);
+
+		// A >= B >= C: C corner moves, B - C edge moves and A - B straight moves
+		if (A < B) Swap(A, B);
+		if (B < C) Swap(B, C);
+		if (A < B) Swap(A, B);
+
+		return A + (UE_SQRT_2 - 1.f) * B + (UE_SQRT_3 - UE_SQRT_2) * C;
+	}
+
+	static FORCEINLINE float AStarHeuristic(int32 AX, int32 AY, int32 AZ, const FIntVector& EndXYZ)
+	{
+		return OctileDistance(AX - EndXYZ.X, AY - EndXYZ.Y, AZ - EndXYZ.Z);
+	}
+
+	// Landmarks, see MGDNLandmarks.cpp
+	void BuildLandmarks();
+
+	// Baked path cost from every landmark to a walkable cell, nullptr without landmarks or outside their region
+	FORCEINLINE const float* GetLandmarkCosts(int32 Index) const
+	{
+		if (LandmarkCosts.Num() == 0)
+			return nullptr;
+
+		// Costs are baked path lengths, blocked cells only make paths longer so they stay a lower bound in the baked region
+		const int32 Rank = Walkable.Rank(Index);
+		if ((BakedComponents.Num() > 0 ? BakedComponents[Rank] : GetComponent(Index)) != LandmarkComponent)
+			return nullptr;
+
+		return &LandmarkCosts[Walkable.Rank(Index) * Landmarks.Num()];
+	}
+
+	// Octile distance from a cell at AX,AY,AZ to the end cell, raised to the landmark bound when EndCosts is the
+	// end's GetLandmarkCosts. Index must be the cell at AX,AY,AZ and connected to the end.
+	FORCEINLINE float PathHeuristic(int32 Index, int32 AX, int32 AY, int32 AZ, const FIntVector& EndXYZ, const float* EndCosts) const
+	{
+		const float H = AStarHeuristic(AX, AY, AZ, EndXYZ);
+		return EndCosts ? LandmarkHeuristic(Index, EndCosts, H) : H;
+	}
+
+	// Raises H to the landmark bound between Index and the cell of EndCosts, which must not be null
+	FORCEINLINE float LandmarkHeuristic(int32 Index, const float* EndCosts, float H) const
+	{
+		// Triangle inequality: a path to the end is at least as long as the difference of both cells' landmark costs
+		const float* Costs = &LandmarkCosts[Walkable.Rank(Index) * Landmarks.Num()];
+		for (int32 i = 0; i < Landmarks.Num(); ++i)
 		{
-			for (int32 DX = -R; DX <= R; DX++)
-				for (int32 DY = -R; DY <= R; DY++)
-					for (int32 DZ = -R; DZ <= R; DZ++)
-					{
-						const int32 NX = SX + DX;
-						const int32 NY = SY + DY;
-						const int32 NZ = SZ + DZ;
-
-						if (!IsValid(NX, NY, NZ))
-							continue;
-
-						const int32 NI = ToIndex(NX, NY, NZ);
-						if (Walkable.IsValidIndex(NI) && Walkable[NI])
-							return NI;
-					}
+			H = FMath::Max(H, FMath::Abs(Costs[i] - EndCosts[i]));
 		}
 
-		return -1; // none found
+		return H;
 	}
 
-	//Find Neighbours
-	void AddNeighbors6(int32 Index, TArray<int32>& Out) const;
-	void AddNeighbors26(int32 Index, TArray<int32>& Out) const;
+	// Resets S and queues Start
+	void BeginAStar(FMGDNSearchState& S, int32 Start, int32 End, float HeuristicWeight, FMGDNSearchStats& Stats) const;
+
+	// Runs up to MaxExpansions A* expansions, returns true once End was reached or the open list ran empty.
+	// Cells other than End with less than MinClearance are never entered. FPolicy is a TMGDNSearchPolicy,
+	// see MGDNSearchPolicies.h, called through SelectExpandAStar.
+	template<typename FPolicy>
+	bool ExpandAStar(FMGDNSearchState& S, int32 End, float HeuristicWeight, float MinClearance, int32 MaxExpansions,
+	                 const FMGDNGridBounds* Bounds, FMGDNSearchStats& Stats, bool& bOutFound) const;
+
+	// Jump Point Search, see MGDNJumpPointSearch.cpp
+	void BuildJumpStops();
+	void BuildJumpTable();
+	bool IsJumpPoint(int32 X, int32 Y, int32 Z, int32 DX, int32 DY) const;
+	int32 JumpStraight(int32 X, int32 Y, int32 Z, int32 DX, int32 DY, int32 End, const FIntVector& EndXYZ) const;
+	int32 Jump(int32 X, int32 Y, int32 Z, int32 DX, int32 DY, int32 End, const FIntVector& EndXYZ) const;
+	void AddJumpSuccessors(int32 Index, int32 ParentIndex, int32 End, TArray<int32>& Out) const;
+	void ExpandJumpPath(const TArray<int32>& JumpPoints, TArray<int32>& OutIndices) const;
+	bool JumpPointSearch(int32 Start, int32 End, TArray<int32>& OutIndices, FMGDNSearchStats* OutStats,
+	                     float HeuristicWeight = 1.f) const;
+
+	// Hierarchical search, see MGDNHierarchicalSearch.cpp
+	void BuildClusterGraph();
+	void FloodCosts(int32 Source, const FMGDNGridBounds& Bounds, const TArray<int32>& Targets,
+	                FMGDNSearchState& S, FMGDNSearchStats& Stats) const;
+	bool HierarchicalSearch(int32 Start, int32 End, TArray<int32>& OutIndices, FMGDNSearchStats* OutStats) const;
+
+	uint32 NavVersion = 0;
+	uint32 GridVersion = 0;
+
+	// Path cost over the baked moves from each landmark, Landmarks.Num() entries per walkable cell at Walkable.Rank(Index)
+	TArray<float> LandmarkCosts;
+
+	// Region the landmarks were picked in, other regions only use the octile distance
+	int32 LandmarkComponent = INDEX_NONE;
+
+	// Move cost scale per walkable cell at Walkable.Rank(Index), empty until SetCellCosts
+	TArray<float> CellCosts;
+
+	// Obstacles by id, and the number of obstacles overlapping each covered cell
+	TMap<int32, FMGDNObstacle> Obstacles;
+	TMap<int32, int32> ObstacleRefs;
+
+	// Moves the references of an obstacle from OldCells to NewCells and flips the cells whose count starts or stops
+	// at zero. Both lists ascending. Returns true when any cell flipped.
+	bool RestampObstacleCells(const TArray<int32>& OldCells, const TArray<int32>& NewCells);
+
+	// Closes walkable cells to every move, or reopens them with their baked moves, and logs them for incremental searches.
+	// Walkable bits, clearance and nearest cells keep their baked values, components are relabeled on their next read.
+	// Returns true when any cell flipped.
+	bool SetCellsBlocked(TConstArrayView<int32> Cells, bool bBlocked);
+
+	// Runtime closed cells, sized on the first SetCellsBlocked
+	FMGDNWalkableBits BlockedCells;
+	int32 NumBlockedCells = 0;
+
+	// Connectivity as baked, copied on the first SetCellsBlocked so reopened cells get their moves back
+	TArray<uint32> BakedConnectivity;
+
+	// Components as baked, copied on the first SetCellsBlocked, landmark regions keep using these
+	TArray<int32> BakedComponents;
+
+	// Set by SetCellsBlocked, the first GetComponent after it relabels under ComponentsLock
+	mutable std::atomic<bool> bComponentsStale = false;
+	mutable FCriticalSection ComponentsLock;
+
+	void RefreshComponents() const;
+
+	struct FMGDNCellChange
+	{
+		uint32 Version = 0;
+		int32 Cell = INDEX_NONE;
+	};
+
+	// Cells flipped by SetCellsBlocked in version order, complete for every version from CellChangesFrom on
+	TArray<FMGDNCellChange> CellChanges;
+	uint32 CellChangesFrom = 0;
+
+	// Index paths of FindPath by resolved cells and options, empty for queries without a path
+	mutable TLruCache<FMGDNPathCacheKey, TArray<int32>> PathCache;
+	mutable FMGDNPathCacheStats PathCacheStats;
+	mutable FCriticalSection PathCacheLock;
+
+	// True and OutIndices set when Key is cached
+	bool FindCachedPath(const FMGDNPathCacheKey& Key, TArray<int32>& OutIndices) const;
+
+	// Stores a path searched at nav version Version, unless the grid changed since
+	void AddCachedPath(const FMGDNPathCacheKey& Key, const TArray<int32>& Indices, uint32 Version) const;
+
+	// Drops cached paths without bumping NavVersion, for changes only A* reads
+	void ClearPathCache();
+
+	// Line of sight stepping only by moves in MoveBits, with bCellCosts entering no cell costing more than 1 before To
+	bool TraceLineOfSight(int32 From, int32 To, float MinClearance, uint32 MoveBits, bool bCellCosts) const;
+
+	// String pulls InOutIndices along TraceLineOfSight
+	void PullIndexPath(TArray<int32>& InOutIndices, float MinClearance, uint32 MoveBits, bool bCellCosts) const;
+
+	// Flow fields, see MGDNFlowField.cpp
+	void BuildFlowField(FMGDNFlowField& Field) const;
+
+	// Fields handed out by GetFlowField by goal cell and clearance, their holders keep them alive
+	mutable TMap<uint64, TWeakPtr<const FMGDNFlowField>> FlowFields;
+	mutable FCriticalSection FlowFieldLock;
+
+	// Incremental search, see MGDNIncrementalSearch.cpp
+	float IncrementalRhs(FMGDNIncrementalPath& Path, int32 Cell) const;
+	bool RerootIncrementalPath(FMGDNIncrementalPath& Path, int32 NewGoal) const;
+	void UpdateIncrementalCell(FMGDNIncrementalPath& Path, int32 Cell, const FIntVector& StartXYZ) const;
+	bool ComputeIncrementalPath(FMGDNIncrementalPath& Path) const;
 
-	bool AStar(int32 Start, int32 End, TArray<int32>& OutIndices) const;
+	// Bidirectional search, see MGDNBidirectionalSearch.cpp
+	bool BidirectionalSearch(int32 Start, int32 End, TArray<int32>& OutIndices, FMGDNSearchStats* OutStats,
+	                         float MinClearance = 0.f) const;
 };
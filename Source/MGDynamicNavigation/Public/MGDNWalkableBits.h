@@ -0,0 +1,102 @@
+﻿// MG Dynamic Navigation plugin Created by Cem Akkaya licensed under MIT.
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Walkability of every grid cell packed one bit per cell into 64-bit words.
+ * Bit order follows the grid index, with zero padding before and after the grid so the
+ * 3x3x3 block around any cell can be read without bounds checks.
+ */
+struct MGDYNAMICNAVIGATION_API FMGDNWalkableBits
+{
+	// Bit of a neighbour offset inside a NeighborMask
+	static constexpr int32 BitOf(int32 DX, int32 DY, int32 DZ)
+	{
+		return (DX + 1) + (DY + 1) * 3 + (DZ + 1) * 9;
+	}
+
+	// Offset of a NeighborMask bit from the centre cell
+	static FORCEINLINE FIntVector BitDelta(int32 Bit)
+	{
+		return FIntVector(Bit % 3 - 1, (Bit / 3) % 3 - 1, Bit / 9 - 1);
+	}
+
+	static constexpr uint32 CenterBit = 1u << 13;
+
+	// Neighbours in the same layer, and in the layers above and below
+	static constexpr uint32 PlanarBits   = 0x003DE00u;
+	static constexpr uint32 VerticalBits = 0x7FC01FFu;
+
+	/** Bits of NeighborMask that leave a box through its faces, pass true for each face the cell touches. */
+	static FORCEINLINE uint32 ClipMask(bool bMinX, bool bMaxX, bool bMinY, bool bMaxY, bool bMinZ, bool bMaxZ)
+	{
+		return (bMinX ? 0x1249249u : 0u) | (bMaxX ? 0x4924924u : 0u) |
+			   (bMinY ? 0x01C0E07u : 0u) | (bMaxY ? 0x70381C0u : 0u) |
+			   (bMinZ ? 0x00001FFu : 0u) | (bMaxZ ? 0x7FC0000u : 0u);
+	}
+
+	void Init(int32 InGridX, int32 InGridY, int32 InGridZ);
+	void Reset();
+
+	FORCEINLINE int32 Num() const { return NumCells; }
+
+	FORCEINLINE bool IsValidIndex(int32 Index) const
+	{
+		return Index >= 0 && Index < NumCells;
+	}
+
+	FORCEINLINE bool operator[](int32 Index) const
+	{
+		const int32 Bit = Index + PadBits;
+		return (Words[Bit >> 6] >> (Bit & 63)) & 1;
+	}
+
+	FORCEINLINE void Set(int32 Index, bool bWalkable)
+	{
+		const int32 Bit = Index + PadBits;
+		const uint64 Flag = uint64(1) << (Bit & 63);
+
+		if (bWalkable)
+			Words[Bit >> 6] |= Flag;
+		else
+			Words[Bit >> 6] &= ~Flag;
+	}
+
+	/**
+	 * Walkable cells of the 3x3x3 block centred on Index as a 27-bit mask, see BitOf.
+	 * X and Y must be the coordinates of Index. Cells outside the grid read as blocked.
+	 */
+	uint32 NeighborMask(int32 Index, int32 X, int32 Y) const;
+
+	int32 CountWalkable() const;
+
+	/** Prepares Rank, call again after changing bits. */
+	void BuildRanks();
+
+	/** Number of walkable cells before Index, a dense slot for per walkable cell data. */
+	FORCEINLINE int32 Rank(int32 Index) const
+	{
+		const int32 Bit = Index + PadBits;
+		const uint64 Below = (uint64(1) << (Bit & 63)) - 1;
+		return WordRanks[Bit >> 6] + int32(FMath::CountBits(Words[Bit >> 6] & Below));
+	}
+
+	SIZE_T GetAllocatedSize() const { return Words.GetAllocatedSize() + WordRanks.GetAllocatedSize(); }
+
+private:
+
+	TArray<uint64> Words;
+
+	// Walkable cells in all words before each word
+	TArray<int32> WordRanks;
+
+	int32 NumCells = 0;
+	int32 GridX = 0;
+	int32 GridY = 0;
+
+	// Zero bits in front of cell 0, at least one layer and one row so Z-1 reads stay inside
+	int32 PadBits = 0;
+
+	// Bit distance from a cell to the X-1 cell of each of the 9 rows around it, row r = (DY+1) + (DZ+1)*3
+	int32 RowDelta[9] = {};
+};
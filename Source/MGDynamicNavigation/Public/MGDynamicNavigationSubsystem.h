@@ -2,15 +2,18 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "MGDNNavDataAsset.h"
+#include "MGDNRuntimeNavMesh.h"
 #include "Navigation/PathFollowingComponent.h"
 #include "Components/SplineComponent.h"
 #include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
 #include "MGDynamicNavigationSubsystem.generated.h"
 
 class AAIController;
 class APawn;
 class UMGDNNavVolumeComponent;
 class UMGDNRuntimeNavMesh;
+struct FMGDNSlicedSearch;
 
 UENUM(BlueprintType)
 enum class EMGDNMoveResult : uint8
@@ -22,6 +25,7 @@ enum class EMGDNMoveResult : uint8
     Failed_RuntimeNavMissing,
     Failed_InvalidController,
     Failed_MoveRequest,
+    Failed_TargetLost,
 };
 
 DECLARE_DYNAMIC_DELEGATE_OneParam(FMGDNMoveFinishedDynamicDelegate, EMGDNMoveResult, Result);
@@ -58,6 +62,95 @@ struct FMGDNActiveMove
     UPROPERTY() float FreezeTimer = 0.f;
     
     bool bDirectMove = false;
+
+    // Flow field the move was planned on, see bUseFlowFields. Replans follow it too and it stays cached while held.
+    TSharedPtr<const FMGDNFlowField> FlowField;
+
+    // Nav the path was planned on and the version its path was last checked against. Changes elsewhere on the grid
+    // only bump it, the move replans once cells along the rest of its path are blocked or reopened
+    UPROPERTY() UMGDNRuntimeNavMesh* RuntimeNav = nullptr;
+    uint32 NavVersion = 0;
+
+    // Options the move was planned with, replans and detours search with them too
+    FMGDNPathQuery Query;
+
+    // D* Lite search started on the first replan, later replans only repair what the changed cells affect.
+    // Unused for queries without UMGDNRuntimeNavMesh::HasDefaultMoves, those replan with a new search.
+    TSharedPtr<FMGDNIncrementalPath> Replanner;
+
+    // Actor the move chases, see MoveToActorMGDNAsync. Its platform local position is the goal of every replan.
+    UPROPERTY() TWeakObjectPtr<AActor> FollowTarget;
+    bool bFollowTarget = false;
+
+    // Seconds until the target's position is checked again
+    float FollowCooldown = 0.f;
+};
+
+/** Actor whose collision bounds block nav cells, see UMGDynamicNavigationSubsystem::RegisterObstacle. */
+USTRUCT()
+struct FMGDNObstacleActor
+{
+    GENERATED_BODY()
+
+    UPROPERTY() TWeakObjectPtr<AActor> Actor;
+    UPROPERTY() UMGDNNavVolumeComponent* Volume = nullptr;
+
+    int32 ObstacleId = INDEX_NONE;
+
+    // Actor transform relative to the platform when the obstacle was last placed
+    FTransform LastRelative;
+};
+
+/** Worker side output of a path request, read on the game thread once the task completes. */
+struct FMGDNPathTaskResult
+{
+    bool bFound = false;
+    TArray<FVector> WorldPath;
+    TSharedPtr<const FMGDNFlowField> FlowField;
+};
+
+USTRUCT()
+struct FMGDNPathRequest
+{
+    GENERATED_BODY()
+
+    UPROPERTY() AAIController* Controller = nullptr;
+    UPROPERTY() AActor* Platform = nullptr;
+
+    // Held so GC keeps the nav alive while a worker reads it
+    UPROPERTY() UMGDNRuntimeNavMesh* RuntimeNav = nullptr;
+
+    UPROPERTY() FVector Goal = FVector::ZeroVector;
+    UPROPERTY() float AcceptanceRadius = 50.f;
+    UPROPERTY() float MoveSpeed = 400.f;
+    UPROPERTY() FMGDNMoveFinishedDynamicDelegate Callback;
+
+    // Set by MoveToActorMGDNAsync, the move made from the request keeps following it
+    UPROPERTY() TWeakObjectPtr<AActor> FollowTarget;
+
+    // Platform transform the worker searched with, paths are converted back with the same one
+    FTransform PlatformTransform;
+
+    // Options the request was issued with, PathQuery may have changed by the time a sliced search finishes
+    FMGDNPathQuery Query;
+
+    // Pawn location the search starts from
+    FVector Start = FVector::ZeroVector;
+
+    // Not launched yet, its volume has obstacle changes waiting for worker searches, see LaunchPathRequest
+    bool bHeld = false;
+
+    // Nav version the search ran on
+    uint32 NavVersion = 0;
+
+    UE::Tasks::TTask<FMGDNPathTaskResult> Task;
+
+    // Set instead of Task for searches the game thread runs under SearchExpansionsPerFrame
+    TSharedPtr<FMGDNSlicedSearch> Sliced;
+
+    // World path of Sliced once done, taken before a rebuild can give its cells another meaning
+    FMGDNPathTaskResult SlicedResult;
+    bool bSlicedResolved = false;
 };
 
 
@@ -70,6 +163,41 @@ public:
 
     UPROPERTY() TArray<FMGDNInstance> Instances;
     UPROPERTY() TArray<FMGDNActiveMove> ActiveMoves;
+
+    // Searches running on worker threads, turned into moves by the tick once done
+    UPROPERTY() TArray<FMGDNPathRequest> PendingPaths;
+
+    // Actors blocking the cells under them, moved along by the tick
+    UPROPERTY() TArray<FMGDNObstacleActor> ObstacleActors;
+
+    // Finished searches turned into moves per tick, spline building and surface traces stay on the game thread
+    int32 MaxPathResultsPerTick = 32;
+
+    // When above zero, searches run on the game thread instead of workers and all pending ones
+    // share this many A* expansions per tick, so even unreachable goals cost bounded work per frame
+    int32 SearchExpansionsPerFrame = 0;
+
+    // Game thread searches advanced at once, oldest first. Each one holds records for every cell of its nav
+    // until it is done, later requests wait without any
+    int32 MaxSlicedSearches = 16;
+
+    // Requests follow a flow field of their goal cell shared with every other request to it instead of running their own
+    // search, so mass orders to one station cost one search. Flow requests always run on workers.
+    // Queries with other moves or cell costs search on their own, see UMGDNRuntimeNavMesh::HasDefaultMoves.
+    bool bUseFlowFields = false;
+
+    // Search options of every MoveToLocationMGDNAsync request, raise HeuristicWeight to trade path length for time under load.
+    // AgentRadius is raised to the pawn's capsule radius per request.
+    FMGDNPathQuery PathQuery;
+
+    // Avoidance detours search this many cells of the path ahead and rejoin it there, the rest of the route is kept
+    int32 DetourWindowCells = 8;
+
+    // Expansions a detour search may spend, past that the detour is dropped. Keeps its cost bounded however long the route is.
+    int32 DetourMaxExpansions = 512;
+
+    // Seconds between checks of a followed target, it replans once the target left the cell its path ends in
+    float FollowReplanInterval = 0.25f;
     
     // Helper functions for status queries
     
@@ -88,8 +216,24 @@ public:
     /** Returns the platform actor the pawn is on (nullptr if none) */
     UFUNCTION(BlueprintCallable, Category="MGDN")
     AActor* GetPawnPlatform(APawn* Pawn) const;
+
+    /** Blocks the nav cells under the actor's collision bounds on the platform it is in, following it while it moves. */
+    UFUNCTION(BlueprintCallable, Category="MGDN")
+    bool RegisterObstacle(AActor* Actor);
+
+    UFUNCTION(BlueprintCallable, Category="MGDN")
+    void UnregisterObstacle(AActor* Actor);
+
+    /**
+     * Path from the pawn to whichever of Goals it reaches soonest on its platform, e.g. the closest exit, in one search.
+     * Uses PathQuery and the pawn's capsule like MoveToLocationMGDNAsync but runs right away on the game thread.
+     * OutGoalIndex is the winning entry of Goals, INDEX_NONE when none can be reached.
+     */
+    UFUNCTION(BlueprintCallable, Category="MGDN")
+    bool FindPathToNearestMGDN(APawn* Pawn, const TArray<FVector>& Goals, int32& OutGoalIndex, TArray<FVector>& OutPath);
     
     virtual void Tick(float DeltaTime) override;
+    virtual void Deinitialize() override;
     
     void RegisterVolume(UMGDNNavVolumeComponent* Volume);
     void DeregisterVolume(UMGDNNavVolumeComponent* Volume);
@@ -100,12 +244,41 @@ public:
 
     void TickMGDN(float DeltaTime);
 
+    /** Moves obstacles whose actors moved on their platform since the last tick, and drops destroyed ones. */
+    void UpdateObstacles();
+
+    /** Creates moves for finished path requests, at most MaxPathResultsPerTick per call. */
+    void ProcessPathRequests();
+
+    /** Advances game thread searches, spending up to SearchExpansionsPerFrame expansions across them. */
+    void StepSlicedPathRequests();
+
+    /** Blocks until all searches on Nav are done, or all searches when Nav is null. Call before rebuilding nav data. */
+    void WaitForPathRequests(const UMGDNRuntimeNavMesh* Nav = nullptr);
+
+    /** Converts the cells of a done sliced request to its SlicedResult, once. */
+    static void ResolveSlicedPathRequest(FMGDNPathRequest& Request);
+
+    /** True while a worker thread searches Nav. Game thread searches never overlap a nav change. */
+    bool HasRunningPathRequests(const UMGDNRuntimeNavMesh* Nav) const;
+
+    /** Starts the search of Request, or holds it while its volume has queued obstacle changes that a worker search would delay. */
+    void LaunchPathRequest(FMGDNPathRequest& Request);
+
     bool HandleAvoidanceFreeze(FMGDNActiveMove& M, APawn* Pawn, UCapsuleComponent* Capsule,
                                const FTransform& PlatformTransform);
     
+    /** Steps around a pawn blocking M, searching only DetourWindowCells of the path ahead and keeping the rest of it. */
     bool InsertAvoidanceDetour(FMGDNActiveMove& M, APawn* Pawn, UCapsuleComponent* Capsule,
                                const FTransform& PlatformTransform);
 
+    /** Replans M from the pawn after its nav changed or its follow target moved, returns false when the goal cannot be reached anymore. */
+    bool ReplanChangedPath(FMGDNActiveMove& M, APawn* Pawn, UCapsuleComponent* Capsule,
+                           const FTransform& PlatformTransform);
+
+    /** True when cells changed since M.NavVersion lie within AgentRadius of the part of M's spline still ahead of PawnLocal. */
+    static bool IsPathNearChangedCells(const FMGDNActiveMove& M, const FVector& PawnLocal, float AgentRadius);
+
     static float GetSurfaceZ_Local(const UMGDNNavDataAsset* Asset, const FVector& Local);
     
     static FVector GetSurfacePoint_Local(const UMGDNNavDataAsset* Asset, const FVector& Local);
@@ -116,7 +289,7 @@ public:
         const FVector& Local,
         UWorld* World);
 
-    /** Controller commonly used move function using pathfinding. */
+    /** Controller commonly used move function using pathfinding. The search runs on a worker thread and the move starts on a later tick. */
     UFUNCTION(BlueprintCallable)
     void MoveToLocationMGDNAsync(
         AAIController* Controller,
@@ -124,6 +297,18 @@ public:
         float AcceptanceRadius,
         float MoveSpeed, FMGDNMoveFinishedDynamicDelegate Callback);
     
+    /**
+     * Moves to Target and keeps chasing it while it walks around the platform, succeeding once within AcceptanceRadius.
+     * The first path comes from a worker like MoveToLocationMGDNAsync, later ones repair the previous search as the
+     * target changes cells, see UMGDNRuntimeNavMesh::FollowIncrementalPath. Fails with Failed_TargetLost if Target is destroyed.
+     */
+    UFUNCTION(BlueprintCallable)
+    void MoveToActorMGDNAsync(
+        AAIController* Controller,
+        AActor* Target,
+        float AcceptanceRadius,
+        float MoveSpeed, FMGDNMoveFinishedDynamicDelegate Callback);
+
     /** Move function not using pathfinding. Direct Move can be used to offboard AI from platform or onto it. */
     UFUNCTION(BlueprintCallable)
     void MoveDirectMGDNAsync(AAIController* Controller, const FVector& Goal, float MoveSpeed,